@@ -30,6 +30,9 @@ LIBS += -lphonenumber
 # We need access to QtContacts private headers
 QT += contacts-private
 
+# Contacts are decoded and sorted using the global thread pool
+QT += concurrent
+
 # We need the moc output for ContactManagerEngine from sqlite-extensions
 extensionsIncludePath = $$system($$PKG_CONFIG --cflags-only-I qtcontacts-sqlite-qt$${QT_MAJOR_VERSION}-extensions)
 VPATH += $$replace(extensionsIncludePath, -I, )
@@ -52,6 +55,7 @@ PUBLIC_HEADERS = \
     $$PWD/seasideexport.h \
     $$PWD/seasideimport.h \
     $$PWD/seasidecontactbuilder.h \
+    $$PWD/seasidecontactidlist.h \
     $$PWD/synchronizelists.h \
     $$PWD/seasidepropertyhandler.h
 
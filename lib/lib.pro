@@ -4,6 +4,9 @@ TEMPLATE = lib
 
 # 'contacts' is too generic for the target name - use 'contactcache'
 TARGET = contactcache-qt$${QT_MAJOR_VERSION}
+# The major version is the soname; increment it whenever the binary interface of the
+# public headers changes, such as the virtual functions or layout of their classes
+VERSION = 2.0.0
 target.path = $$[QT_INSTALL_LIBS]
 INSTALLS += target
 
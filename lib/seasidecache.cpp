@@ -44,20 +44,29 @@
 
 #include <QCoreApplication>
 #include <QStandardPaths>
+#include <QDataStream>
 #include <QDBusConnection>
 #include <QDir>
 #include <QEvent>
 #include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 
 #include <QContactAvatar>
 #include <QContactDetailFilter>
 #include <QContactCollectionFilter>
+#include <QContactUnionFilter>
 #include <QContactDisplayLabel>
 #include <QContactEmailAddress>
 #include <QContactFavorite>
 #include <QContactGender>
 #include <QContactName>
 #include <QContactNickname>
+#include <QContactNote>
 #include <QContactOnlineAccount>
 #include <QContactOrganization>
 #include <QContactPhoneNumber>
@@ -80,6 +89,8 @@
 #endif
 #include <phonenumbers/phonenumberutil.h>
 
+#include <algorithm>
+
 QTVERSIT_USE_NAMESPACE
 
 namespace {
@@ -231,6 +242,31 @@ DetailList displayDetails()
     return types;
 }
 
+// Returns the ItemDataChange values reported when details of this type are modified
+quint32 itemDataChanges(QContactDetail::DetailType type)
+{
+    if (type == detailType<QContactName>() || type == detailType<QContactNickname>()
+            || type == detailType<QContactDisplayLabel>()) {
+        return SeasideCache::NameDataChanged;
+    } else if (type == detailType<QContactAvatar>()) {
+        return SeasideCache::AvatarDataChanged;
+    } else if (type == detailType<QContactGlobalPresence>() || type == detailType<QContactPresence>()) {
+        return SeasideCache::PresenceDataChanged;
+    } else if (type == detailType<QContactFavorite>()) {
+        return SeasideCache::FavoriteDataChanged;
+    } else if (type == detailType<QContactPhoneNumber>() || type == detailType<QContactEmailAddress>()
+               || type == detailType<QContactOnlineAccount>()) {
+        return SeasideCache::AddressDataChanged;
+    } else if (type == detailType<QContactOrganization>()) {
+        return SeasideCache::OrganizationDataChanged;
+    } else if (type == detailType<QContactNote>()) {
+        return SeasideCache::NoteDataChanged;
+    }
+
+    // Other details are not presented by list models
+    return 0;
+}
+
 DetailList contactsTableDetails()
 {
     DetailList types;
@@ -337,6 +373,162 @@ QContactFilter favoriteFilter()
     return QContactFavorite::match();
 }
 
+struct SortEntry
+{
+    int group;
+    const SeasideCache::CacheItem *item;
+};
+
+SortEntry sortEntry(const SeasideCache::CacheItem *item, const QStringList &groups)
+{
+    // Unknown groups are ordered after all known groups
+    const int group = groups.indexOf(item->displayLabelGroup);
+    SortEntry entry = { group == -1 ? groups.count() : group, item };
+    return entry;
+}
+
+int compareSortKeys(const SeasideCache::CacheItem *lhs, const SeasideCache::CacheItem *rhs, int key)
+{
+    // Missing keys are blank, and blanks are ordered first
+    const bool lhsBlank = lhs->sortKeys.count() <= key;
+    const bool rhsBlank = rhs->sortKeys.count() <= key;
+    if (lhsBlank || rhsBlank)
+        return (lhsBlank ? 0 : 1) - (rhsBlank ? 0 : 1);
+
+    return lhs->sortKeys.at(key).compare(rhs->sortKeys.at(key));
+}
+
+// Orders items as the contact lists are ordered: display label groups in their configured
+// order, then the name fields in the order selected by the sort property
+class SortOrderLessThan
+{
+public:
+    explicit SortOrderLessThan(bool lastNameFirst)
+        : m_primaryKey(lastNameFirst ? SeasideCache::CacheItem::LastNameSortKey : SeasideCache::CacheItem::FirstNameSortKey)
+        , m_secondaryKey(lastNameFirst ? SeasideCache::CacheItem::FirstNameSortKey : SeasideCache::CacheItem::LastNameSortKey)
+    {
+    }
+
+    bool operator()(const SortEntry &lhs, const SortEntry &rhs) const
+    {
+        if (lhs.group != rhs.group)
+            return lhs.group < rhs.group;
+
+        int rv = compareSortKeys(lhs.item, rhs.item, m_primaryKey);
+        if (rv == 0)
+            rv = compareSortKeys(lhs.item, rhs.item, m_secondaryKey);
+        if (rv == 0)
+            rv = compareSortKeys(lhs.item, rhs.item, SeasideCache::CacheItem::DisplayLabelSortKey);
+        if (rv != 0)
+            return rv < 0;
+
+        return lhs.item->iid < rhs.item->iid;
+    }
+
+private:
+    int m_primaryKey;
+    int m_secondaryKey;
+};
+
+struct SortRange
+{
+    int begin;
+    int middle;
+    int end;
+};
+
+template<typename T, typename LessThan>
+void parallelSort(QVector<T> &values, LessThan lessThan)
+{
+    // Below this size per thread, distributing the work costs more than it saves
+    const int minRangeSize = 2048;
+
+    const int rangeCount = qMin(QThread::idealThreadCount(), values.count() / minRangeSize);
+    if (rangeCount <= 1) {
+        std::sort(values.begin(), values.end(), lessThan);
+        return;
+    }
+
+    // Sort ranges of the input concurrently, then merge adjacent pairs of sorted ranges
+    const typename QVector<T>::iterator base = values.begin();
+
+    QVector<SortRange> ranges;
+    for (int i = 0; i < rangeCount; ++i) {
+        const SortRange range = { values.count() * i / rangeCount, 0, values.count() * (i + 1) / rangeCount };
+        ranges.append(range);
+    }
+    QtConcurrent::blockingMap(ranges, [base, lessThan](const SortRange &range) {
+        std::sort(base + range.begin, base + range.end, lessThan);
+    });
+
+    while (ranges.count() > 1) {
+        QVector<SortRange> merges;
+        for (int i = 0; i + 1 < ranges.count(); i += 2) {
+            const SortRange merge = { ranges.at(i).begin, ranges.at(i).end, ranges.at(i + 1).end };
+            merges.append(merge);
+        }
+        QtConcurrent::blockingMap(merges, [base, lessThan](const SortRange &merge) {
+            std::inplace_merge(base + merge.begin, base + merge.middle, base + merge.end, lessThan);
+        });
+
+        if (ranges.count() % 2) {
+            merges.append(ranges.last());
+        }
+        ranges = merges;
+    }
+}
+
+const quint32 snapshotMagic = 0x4e434353; // 'NCCS'
+const quint32 snapshotVersion = 2;
+
+bool snapshotEnabled()
+{
+    // The test database must never be mixed with the content of the user's database
+    return qgetenv("LIBCONTACTS_TEST_MODE").isEmpty();
+}
+
+QString snapshotPath()
+{
+    // Store the snapshot alongside the database, so that it is subject to the same access control
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/system/privileged/Contacts/nemo-qml-plugin-contacts/cache-snapshot");
+}
+
+DetailList snapshotDetails()
+{
+    // The snapshot contains only the details needed to display the lists; addresses are
+    // fetched once the cache is refreshed
+    DetailList types(contactsTableDetails());
+    types << displayDetails()
+          << detailType<QContactOrganization>()
+          << detailType<QContactAvatar>()
+          << detailType<QContactFavorite>()
+          << detailType<QContactGender>();
+    return types;
+}
+
+// The fetched data types whose details are stored in the snapshot
+const quint32 snapshotFetchTypes = SeasideCache::FetchTypesMask
+        & ~(SeasideCache::FetchAccountUri | SeasideCache::FetchPhoneNumber | SeasideCache::FetchEmailAddress);
+
+QMap<int, QVariant> snapshotValues(const QContactDetail &detail)
+{
+    QMap<int, QVariant> values(detail.values());
+
+    // Values of non-builtin types (such as contexts and subtypes) can't be streamed; they
+    // are not required for display, and are restored when the contact is next fetched
+    QMap<int, QVariant>::iterator it = values.begin();
+    while (it != values.end()) {
+        if (it.value().userType() >= QMetaType::User) {
+            it = values.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return values;
+}
+
 typedef QPair<QString, QString> StringPair;
 
 QList<StringPair> addressPairs(const QContactPhoneNumber &phoneNumber)
@@ -478,10 +670,197 @@ int bestPhoneNumberMatchLength(const QContact &contact, const QString &match)
     return bestMatchLength;
 }
 
+using ::i18n::phonenumbers::PhoneNumberUtil;
+
+// The region in which numbers lacking a country code are presumed to have been dialled
+const std::string &defaultPhoneNumberRegion()
+{
+    static const std::string region(QLocale::system().name().section(QChar::fromLatin1('_'), 1, 1).toStdString());
+    return region;
+}
+
+std::string phoneNumberRegion(const SeasideCache::ParsedPhoneNumber &number)
+{
+    std::string region;
+    PhoneNumberUtil::GetInstance()->GetRegionCodeForCountryCode(number.countryCode, &region);
+    return region;
+}
+
+// Parses a number as libphonenumber does when matching a pair of numbers.  A number lacking a
+// country code is parsed in the region of the number it is matched against; only the default
+// region can be parsed for in advance.
+SeasideCache::ParsedPhoneNumber parsePhoneNumber(const QString &normalized)
+{
+    SeasideCache::ParsedPhoneNumber rv;
+    if (normalized.isEmpty())
+        return rv;
+
+    PhoneNumberUtil *util = PhoneNumberUtil::GetInstance();
+    const std::string number(normalized.toStdString());
+
+    ::i18n::phonenumbers::PhoneNumber parsed;
+    PhoneNumberUtil::ErrorType error = util->Parse(number, "ZZ", &parsed);
+    if (error == PhoneNumberUtil::INVALID_COUNTRY_CODE_ERROR && !defaultPhoneNumberRegion().empty()) {
+        rv.regional = true;
+        error = util->Parse(number, defaultPhoneNumberRegion(), &parsed);
+    }
+
+    if (error == PhoneNumberUtil::NO_PARSING_ERROR) {
+        rv.valid = true;
+        rv.nationalNumber = parsed.national_number();
+        rv.countryCode = parsed.country_code();
+        if (parsed.italian_leading_zero())
+            rv.leadingZeros = parsed.number_of_leading_zeros();
+        if (!parsed.extension().empty())
+            rv.extension = QString::fromStdString(parsed.extension());
+    }
+
+    return rv;
+}
+
+bool isDecimalSuffix(quint64 number, quint64 suffix)
+{
+    quint64 modulus = 10;
+    while (modulus <= suffix)
+        modulus *= 10;
+    return number % modulus == suffix;
+}
+
+// Equivalent to PhoneNumberUtil::IsNumberMatch() for numbers which both have country codes
+PhoneNumberUtil::MatchType comparePhoneNumbers(const SeasideCache::ParsedPhoneNumber &lhs,
+                                               const SeasideCache::ParsedPhoneNumber &rhs)
+{
+    if (!lhs.extension.isEmpty() && !rhs.extension.isEmpty() && lhs.extension != rhs.extension)
+        return PhoneNumberUtil::NO_MATCH;
+    if (lhs == rhs)
+        return PhoneNumberUtil::EXACT_MATCH;
+    if (lhs.countryCode == rhs.countryCode
+            && (isDecimalSuffix(lhs.nationalNumber, rhs.nationalNumber)
+                || isDecimalSuffix(rhs.nationalNumber, lhs.nationalNumber)))
+        return PhoneNumberUtil::SHORT_NSN_MATCH;
+    return PhoneNumberUtil::NO_MATCH;
+}
+
+// Matches a number against indexed numbers, yielding the result of
+// PhoneNumberUtil::IsNumberMatchWithTwoStrings() without reparsing the indexed numbers.
+// The number is parsed on first use, and at most once.
+class PhoneNumberMatcher
+{
+public:
+    explicit PhoneNumberMatcher(const QString &normalized)
+        : m_normalized(normalized)
+        , m_parsed(false)
+    {
+    }
+
+    PhoneNumberUtil::MatchType match(const SeasideCache::CachedPhoneNumber &candidate)
+    {
+        if (!m_parsed) {
+            m_parsed = true;
+            m_number = parsePhoneNumber(m_normalized);
+            if (m_number.valid && !m_number.regional)
+                m_region = phoneNumberRegion(m_number);
+        }
+
+        const SeasideCache::ParsedPhoneNumber &indexed(candidate.parsedNumber);
+        if (m_number.valid && indexed.valid) {
+            if (!m_number.regional && !indexed.regional)
+                return comparePhoneNumbers(m_number, indexed);
+
+            // A number lacking a country code is parsed in the region of the other number, and
+            // cannot then be an exact match
+            const bool sameRegion = m_number.regional ? (phoneNumberRegion(indexed) == defaultPhoneNumberRegion())
+                                                      : (m_region == defaultPhoneNumberRegion());
+            if (sameRegion && m_number.regional != indexed.regional) {
+                const PhoneNumberUtil::MatchType matchType = comparePhoneNumbers(m_number, indexed);
+                return matchType == PhoneNumberUtil::EXACT_MATCH ? PhoneNumberUtil::NSN_MATCH : matchType;
+            }
+        }
+
+        // Defer to libphonenumber where the numbers must be parsed for some other region
+        if (m_normalizedStdStr.empty())
+            m_normalizedStdStr = m_normalized.toStdString();
+        return PhoneNumberUtil::GetInstance()->IsNumberMatchWithTwoStrings(
+                    m_normalizedStdStr, candidate.normalizedNumber.toStdString());
+    }
+
+private:
+    const QString &m_normalized;
+    SeasideCache::ParsedPhoneNumber m_number;
+    std::string m_region;
+    std::string m_normalizedStdStr;
+    bool m_parsed;
+};
+
+// Approximates the memory retained by the details of a contact
+int estimatedContactSize(const QContact &contact)
+{
+    // Allow for the detail and value containers, as well as their content
+    const int detailOverhead = 64;
+    const int valueOverhead = 32;
+
+    int size = 0;
+    foreach (const QContactDetail &detail, contact.details()) {
+        size += detailOverhead;
+
+        const QMap<int, QVariant> values(detail.values());
+        for (QMap<int, QVariant>::const_iterator it = values.constBegin(); it != values.constEnd(); ++it) {
+            size += valueOverhead;
+
+            const QVariant &value(it.value());
+            switch (value.userType()) {
+            case QMetaType::QString:
+                size += value.toString().size() * sizeof(QChar);
+                break;
+            case QMetaType::QByteArray:
+                size += value.toByteArray().size();
+                break;
+            case QMetaType::QStringList:
+                foreach (const QString &string, value.toStringList()) {
+                    size += valueOverhead + string.size() * sizeof(QChar);
+                }
+                break;
+            case QMetaType::QUrl:
+                size += value.toUrl().toString().size() * sizeof(QChar);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    return size;
+}
+
+// The minimum interval between publications of the address snapshot
+const int addressSnapshotInterval = 100;
+
+// Size the next batch so that processing it should take approximately the budgeted time,
+// given that the previous batch of 'processed' items took 'elapsed' nanoseconds
+int nextBatchSize(int processed, qint64 elapsed, int budgetMs)
+{
+    const int maxBatchSize = 1000;
+
+    if (processed <= 0)
+        return 1;
+
+    // Grow gradually, so that a single fast batch cannot produce an excessive estimate
+    const qint64 budget = static_cast<qint64>(budgetMs) * 1000000;
+    const qint64 estimate = elapsed > 0 ? (processed * budget) / elapsed : maxBatchSize;
+    return static_cast<int>(qBound<qint64>(1, qMin<qint64>(estimate, processed * 2), maxBatchSize));
 }
 
+}
+
+// The atomic shared_ptr functions are not lock-free: the standard library guards them with
+// a mutex, so readers contend briefly with publication to copy the pointer.  Lookups on a
+// snapshot once obtained take no locks.
+static std::shared_ptr<const SeasideCache::AddressSnapshot> publishedAddressSnapshot(std::make_shared<SeasideCache::AddressSnapshot>());
+
 SeasideCache *SeasideCache::instancePtr = nullptr;
 int SeasideCache::contactDisplayLabelGroupCount = 0;
+int SeasideCache::batchTimeBudgetMs = 4;
+qint64 SeasideCache::completeContactBudgetBytes = 4 * 1024 * 1024;
 QStringList SeasideCache::allContactDisplayLabelGroups = QStringList();
 QTranslator *SeasideCache::engEnTranslator = nullptr;
 QTranslator *SeasideCache::translator = nullptr;
@@ -539,12 +918,21 @@ SeasideCache::SeasideCache()
     , m_dataTypesFetched(0)
     , m_updatesPending(false)
     , m_refreshRequired(false)
-    , m_contactsUpdated(false)
     , m_displayOff(false)
+    , m_snapshotState(SnapshotCurrent)
+    , m_appendBatchSize(50)
+    , m_updateBatchSize(1)
+    , m_addressSnapshotEpoch(0)
+    , m_completeContactsSize(0)
+    , m_completeContactTick(0)
+    , m_demotedContactCount(0)
+    , m_completeContactsStalled(false)
 {
     m_timer.start();
     m_fetchPostponed.invalidate();
 
+    m_sortCollator.setCaseSensitivity(Qt::CaseInsensitive);
+
     CacheConfiguration *config(cacheConfig());
     connect(config, &CacheConfiguration::displayLabelOrderChanged,
             this, &SeasideCache::displayLabelOrderChanged);
@@ -628,6 +1016,15 @@ SeasideCache::SeasideCache()
 
 SeasideCache::~SeasideCache()
 {
+    // The decode stage holds no references to the cache, but should not outlive it
+    foreach (const DecodeJob &job, m_decodeJobs)
+        job.watcher->waitForFinished();
+
+    // Don't leave the indexes of a destroyed cache visible to other threads
+    std::shared_ptr<AddressSnapshot> snapshot(std::make_shared<AddressSnapshot>());
+    snapshot->m_epoch = m_addressSnapshotEpoch + 1;
+    std::atomic_store(&publishedAddressSnapshot, std::shared_ptr<const AddressSnapshot>(snapshot));
+
     if (instancePtr == this)
         instancePtr = nullptr;
 }
@@ -753,6 +1150,18 @@ void SeasideCache::unregisterResolveListener(ResolveListener *listener)
         }
     }
 
+    QHash<QContactFetchRequest *, QList<ResolveData> >::iterator bit = instancePtr->m_resolveAddressBatches.begin();
+    while (bit != instancePtr->m_resolveAddressBatches.end()) {
+        // Each batch is made for a single listener
+        if (bit.value().first().listener == listener) {
+            bit.key()->cancel();
+            delete bit.key();
+            bit = instancePtr->m_resolveAddressBatches.erase(bit);
+        } else {
+            ++bit;
+        }
+    }
+
     QList<ResolveData>::iterator it2 = instancePtr->m_unknownAddresses.begin();
     while (it2 != instancePtr->m_unknownAddresses.end()) {
         if (it2->listener == listener) {
@@ -902,6 +1311,8 @@ void SeasideCache::ensureCompletion(CacheItem *cacheItem)
 {
     if (cacheItem->contactState < ContactRequested) {
         refreshContact(cacheItem);
+    } else if (cacheItem->contactState == ContactComplete && instancePtr) {
+        instancePtr->touchCompleteContact(cacheItem->iid);
     }
 }
 
@@ -975,6 +1386,49 @@ SeasideCache::CacheItem *SeasideCache::itemByOnlineAccount(const QString &localU
     return nullptr;
 }
 
+std::shared_ptr<const SeasideCache::AddressSnapshot> SeasideCache::addressSnapshot()
+{
+    return std::atomic_load(&publishedAddressSnapshot);
+}
+
+SeasideCache::AddressSnapshot::Contact SeasideCache::AddressSnapshot::contact(quint32 iid) const
+{
+    return m_contacts.value(iid);
+}
+
+SeasideCache::AddressSnapshot::Contact SeasideCache::AddressSnapshot::contactByPhoneNumber(const QString &number) const
+{
+    const QString normalized(normalizePhoneNumber(number));
+    if (normalized.isEmpty())
+        return Contact();
+
+    const QChar plus(QChar::fromLatin1('+'));
+    if (normalized.startsWith(plus)) {
+        // See if there is a match for the complete form of this number
+        if (quint32 iid = matchingPhoneNumber(normalized, normalized)) {
+            return contact(iid);
+        }
+    }
+
+    return contact(matchingPhoneNumber(minimizePhoneNumber(normalized), normalized));
+}
+
+SeasideCache::AddressSnapshot::Contact SeasideCache::AddressSnapshot::contactByEmailAddress(const QString &address) const
+{
+    if (address.trimmed().isEmpty())
+        return Contact();
+
+    return contact(m_emailAddressIds.value(address.toLower()));
+}
+
+SeasideCache::AddressSnapshot::Contact SeasideCache::AddressSnapshot::contactByOnlineAccount(const QString &localUid, const QString &remoteUid) const
+{
+    if (localUid.trimmed().isEmpty() || remoteUid.trimmed().isEmpty())
+        return Contact();
+
+    return contact(m_onlineAccountIds.value(qMakePair(localUid, remoteUid.toLower())));
+}
+
 SeasideCache::CacheItem *SeasideCache::resolvePhoneNumber(ResolveListener *listener, const QString &number, bool requireComplete)
 {
     // Ensure the cache has been instantiated
@@ -1032,6 +1486,61 @@ SeasideCache::CacheItem *SeasideCache::resolveOnlineAccount(ResolveListener *lis
     return item;
 }
 
+// Resolves phone numbers (an empty first value), email addresses (an empty second value) and
+// online accounts (local and remote UIDs) together.  The cached items are returned in the
+// order of the addresses; the remainder are reported to the listener, and fetched in batches.
+QList<SeasideCache::CacheItem *> SeasideCache::resolveAddresses(ResolveListener *listener,
+                                                                const QList<QPair<QString, QString> > &addresses,
+                                                                bool requireComplete)
+{
+    static const int resolveBatchSize = 50;
+
+    // Ensure the cache has been instantiated
+    instance();
+
+    QList<CacheItem *> items;
+    items.reserve(addresses.count());
+
+    QList<ResolveData> unresolved;
+    QSet<QPair<QString, QString> > requested;
+
+    foreach (const StringPair &address, addresses) {
+        CacheItem *item = instancePtr->resolvedItem(address.first, address.second);
+        items.append(item);
+        if (item) {
+            if (requireComplete)
+                ensureCompletion(item);
+            continue;
+        }
+
+        if (requested.contains(address))
+            continue;
+        requested.insert(address);
+
+        ResolveData data;
+        data.first = address.first;
+        data.second = address.second;
+        data.requireComplete = requireComplete;
+        data.listener = listener;
+
+        // Don't bother trying to resolve an invalid number, or an address already sought
+        if ((address.first.isEmpty() && normalizePhoneNumber(address.second).isEmpty())
+                || instancePtr->isKnownUnknownAddress(address.first, address.second)) {
+            // Report this address is unknown
+            instancePtr->m_unknownResolveAddresses.append(data);
+            instancePtr->requestUpdate();
+        } else if (!instancePtr->m_pendingResolve.contains(data)) {
+            unresolved.append(data);
+        }
+    }
+
+    for (int i = 0; i < unresolved.count(); i += resolveBatchSize) {
+        instancePtr->resolveAddressBatch(unresolved.mid(i, resolveBatchSize));
+    }
+
+    return items;
+}
+
 QContactId SeasideCache::selfContactId()
 {
     return manager()->selfContactId();
@@ -1088,6 +1597,34 @@ void SeasideCache::contactDataChanged(quint32 iid, FilterType filter)
     }
 }
 
+void SeasideCache::contactDataChanged(const QList<quint32> &iids, FilterType filter, quint32 changes)
+{
+    QList<ListModel *> &models = m_models[filter];
+    if (models.isEmpty())
+        return;
+
+    QVector<int> rows;
+    rows.reserve(iids.count());
+    for (quint32 iid : iids) {
+        const int row = contactIndex(iid, filter);
+        if (row != -1)
+            rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end());
+
+    // Report each contiguous run of changed rows as a single range
+    for (int i = 0; i < rows.count(); ) {
+        int j = i + 1;
+        while (j < rows.count() && rows.at(j) <= rows.at(j - 1) + 1)
+            ++j;
+
+        for (int k = 0; k < models.count(); ++k) {
+            models.at(k)->sourceDataChanged(rows.at(i), rows.at(j - 1), changes);
+        }
+        i = j;
+    }
+}
+
 bool SeasideCache::removeContact(const QContact &contact)
 {
     return removeContacts(QList<QContact>() << contact);
@@ -1179,9 +1716,58 @@ const QList<quint32> *SeasideCache::contacts(FilterType type)
     // Ensure the cache has been instantiated
     instance();
 
+    // The list copy is maintained only once it has been requested
+    return instancePtr->m_contacts[type].listView();
+}
+
+const SeasideContactIdList *SeasideCache::contactIdList(FilterType type)
+{
+    // Ensure the cache has been instantiated
+    instance();
+
     return &instancePtr->m_contacts[type];
 }
 
+void SeasideCache::setBatchTimeBudget(int milliseconds)
+{
+    // Pending contact changes are applied in batches sized to fit this budget per event loop pass
+    batchTimeBudgetMs = qMax(1, milliseconds);
+}
+
+int SeasideCache::batchTimeBudget()
+{
+    return batchTimeBudgetMs;
+}
+
+void SeasideCache::setCompleteContactBudget(qint64 bytes)
+{
+    completeContactBudgetBytes = qMax<qint64>(0, bytes);
+
+    if (instancePtr && instancePtr->m_completeContactsSize > completeContactBudgetBytes) {
+        instancePtr->m_completeContactsStalled = false;
+        instancePtr->requestUpdate();
+    }
+}
+
+qint64 SeasideCache::completeContactBudget()
+{
+    return completeContactBudgetBytes;
+}
+
+QVariantMap SeasideCache::cacheStatistics()
+{
+    // Ensure the cache has been instantiated
+    instance();
+
+    QVariantMap statistics;
+    statistics.insert(QStringLiteral("contactCount"), instancePtr->m_people.count());
+    statistics.insert(QStringLiteral("completeContactCount"), instancePtr->m_completeContacts.count());
+    statistics.insert(QStringLiteral("completeContactSize"), instancePtr->m_completeContactsSize);
+    statistics.insert(QStringLiteral("completeContactBudget"), completeContactBudgetBytes);
+    statistics.insert(QStringLiteral("demotedContactCount"), instancePtr->m_demotedContactCount);
+    return statistics;
+}
+
 bool SeasideCache::isPopulated(FilterType filterType)
 {
     if (!instancePtr)
@@ -1190,6 +1776,12 @@ bool SeasideCache::isPopulated(FilterType filterType)
     return instancePtr->m_populated & (1 << filterType);
 }
 
+// Background work should be deferred while the display is off
+bool SeasideCache::isDisplayOff()
+{
+    return instancePtr && instancePtr->m_displayOff;
+}
+
 QString SeasideCache::getPrimaryName(const QContact &contact)
 {
     const QContactName nameDetail = contact.detail<QContactName>();
@@ -1745,6 +2337,11 @@ void SeasideCache::startRequest(bool *idleProcessing)
         } else {
             QContactIdFilter filter;
             filter.setIds(m_changedContacts);
+            if (m_keepPopulated) {
+                foreach (const QContactId &id, m_changedContacts) {
+                    m_deltaFetchIds.insert(internalId(id));
+                }
+            }
             m_changedContacts.clear();
 
             // A local ID filter will fetch all contacts, rather than just aggregates;
@@ -1784,13 +2381,17 @@ void SeasideCache::startRequest(bool *idleProcessing)
 
     if (m_refreshRequired) {
         // We can't refresh the IDs til all contacts have been appended
-        if (m_contactsToAppend.isEmpty()) {
+        if (m_contactsToAppend.isEmpty() && m_decodeJobs.isEmpty()) {
             if (m_contactIdRequest.isActive()) {
                 requestPending = true;
             } else {
                 m_refreshRequired = false;
                 m_syncFilter = FilterFavorites;
 
+                // The complete lists are being synchronized, which subsumes any delta changes
+                m_deltaSyncIds.clear();
+                m_deltaRemovedIds.clear();
+
                 m_contactIdRequest.setFilter(favoriteFilter());
                 m_contactIdRequest.setSorting(m_sortOrder);
                 m_contactIdRequest.start();
@@ -1807,6 +2408,32 @@ void SeasideCache::startRequest(bool *idleProcessing)
 
             m_contactIdRequest.start();
         }
+    } else if (m_syncFilter == FilterNone && (!m_deltaSyncIds.isEmpty() || !m_deltaRemovedIds.isEmpty())) {
+        // Place the contacts changed since the lists were synchronized, once their data is applied
+        if (m_contactsToAppend.isEmpty() && m_contactsToUpdate.isEmpty() && m_decodeJobs.isEmpty()) {
+            applyDeltaSync();
+        }
+    } else if (m_syncFilter == FilterNone
+               && (m_snapshotState == SnapshotRefreshFavorites || m_snapshotState == SnapshotRefreshAll)) {
+        // The membership of the lists is now synchronized; refresh the data restored from the
+        // snapshot, since contacts may have been modified while we were not running
+        if (m_fetchRequest.isActive()) {
+            requestPending = true;
+        } else {
+            if (m_snapshotState == SnapshotRefreshFavorites) {
+                m_fetchRequest.setFilter(favoriteFilter());
+                m_fetchRequest.setFetchHint(favoriteFetchHint(m_dataTypesFetched));
+                m_snapshotState = SnapshotRefreshAll;
+            } else {
+                m_fetchRequest.setFilter(allFilter());
+                m_fetchRequest.setFetchHint(metadataFetchHint(m_dataTypesFetched | SeasideCache::FetchGender));
+                m_snapshotState = SnapshotSaveRequired;
+            }
+            m_fetchRequest.setSorting(QList<QContactSortOrder>());
+            m_fetchRequest.start();
+
+            m_fetchProcessedCount = 0;
+        }
     }
 
     if (!m_relationshipsToSave.isEmpty() || !m_relationshipsToRemove.isEmpty()) {
@@ -1985,6 +2612,11 @@ void SeasideCache::startRequest(bool *idleProcessing)
                 filter.setIds(m_changedContacts);
                 m_changedContacts.clear();
             }
+            if (m_keepPopulated) {
+                foreach (const QContactId &id, filter.ids()) {
+                    m_deltaFetchIds.insert(internalId(id));
+                }
+            }
 
             // A local ID filter will fetch all contacts, rather than just aggregates;
             // we only want to retrieve aggregate contacts that have changed
@@ -2021,23 +2653,62 @@ void SeasideCache::startRequest(bool *idleProcessing)
         }
     }
 
-    if (requestPending) {
-        // Don't proceed if we were unable to start one of the above requests
-        return;
-    }
+    if (!m_typedChangedContacts.isEmpty()) {
+        if (m_fetchRequest.isActive()) {
+            requestPending = true;
+        } else if (!m_displayOff) {
+            const int maxRequestIds = 200;
 
-    // No remaining work is pending - do we have any background task requests?
-    if (m_extraFetchTypes) {
-        quint32 unfetchedTypes = m_extraFetchTypes & ~m_dataTypesFetched & SeasideCache::FetchTypesMask;
-        if (unfetchedTypes) {
-            if (m_fetchRequest.isActive()) {
-                requestPending = true;
-            } else {
-                quint32 fetchType = 0;
+            // Fetch only the details reported as changed; the remainder are retained from the cache
+            QPair<QSet<QContactDetail::DetailType>, QList<QContactId> > &changes(m_typedChangedContacts.first());
 
-                // Load extra data items that we want to be able to search on, if not already fetched
-                if (unfetchedTypes & SeasideCache::FetchOrganization) {
-                    // since this uses allFilter(), might as well grab
+            QContactIdFilter filter;
+            if (changes.second.count() > maxRequestIds) {
+                filter.setIds(changes.second.mid(0, maxRequestIds));
+                changes.second = changes.second.mid(maxRequestIds);
+            } else {
+                filter.setIds(changes.second);
+                changes.second.clear();
+            }
+            if (m_keepPopulated) {
+                foreach (const QContactId &id, filter.ids()) {
+                    m_deltaFetchIds.insert(internalId(id));
+                }
+            }
+
+            QContactFetchHint fetchHint(basicFetchHint());
+            setDetailTypesHint(fetchHint, changes.first.values());
+
+            if (changes.second.isEmpty()) {
+                m_typedChangedContacts.removeFirst();
+            }
+
+            m_fetchRequest.setFilter(filter & aggregateFilter());
+            m_fetchRequest.setFetchHint(fetchHint);
+            m_fetchRequest.setSorting(QList<QContactSortOrder>());
+            m_fetchRequest.start();
+
+            m_fetchProcessedCount = 0;
+        }
+    }
+
+    if (requestPending) {
+        // Don't proceed if we were unable to start one of the above requests
+        return;
+    }
+
+    // No remaining work is pending - do we have any background task requests?
+    if (m_extraFetchTypes) {
+        quint32 unfetchedTypes = m_extraFetchTypes & ~m_dataTypesFetched & SeasideCache::FetchTypesMask;
+        if (unfetchedTypes) {
+            if (m_fetchRequest.isActive()) {
+                requestPending = true;
+            } else {
+                quint32 fetchType = 0;
+
+                // Load extra data items that we want to be able to search on, if not already fetched
+                if (unfetchedTypes & SeasideCache::FetchOrganization) {
+                    // since this uses allFilter(), might as well grab
                     // all the missing detail types
                     fetchType = unfetchedTypes;
                     m_fetchRequest.setFilter(allFilter());
@@ -2124,12 +2795,25 @@ bool SeasideCache::event(QEvent *event)
                 QHash<quint32, CacheItem>::iterator cacheItem = m_people.find(iid);
                 if (cacheItem != m_people.end()) {
                     delete cacheItem->itemData;
+                    invalidateAddressSnapshot();
+                    m_snapshotContacts.remove(iid);
+                    forgetCompleteContact(iid);
                     m_people.erase(cacheItem);
                 }
             }
 
             updateSectionBucketIndexCaches();
         }
+
+        if (m_snapshotState == SnapshotSaveRequired && !m_fetchRequest.isActive()) {
+            // All fetched content has been applied; record it for the next session
+            m_snapshotState = SnapshotCurrent;
+            saveSnapshot();
+        }
+
+        if (m_completeContactsSize > completeContactBudgetBytes) {
+            demoteCompleteContacts();
+        }
     }
     return true;
 }
@@ -2143,6 +2827,10 @@ void SeasideCache::timerEvent(QTimerEvent *event)
         }
     }
 
+    if (event->timerId() == m_addressSnapshotTimer.timerId()) {
+        publishAddressSnapshot();
+    }
+
     if (event->timerId() == m_expiryTimer.timerId()) {
         m_expiryTimer.stop();
         instancePtr = 0;
@@ -2161,19 +2849,52 @@ void SeasideCache::contactsAdded(const QList<QContactId> &ids)
 
 void SeasideCache::contactsChanged(const QList<QContactId> &ids, const QList<QContactDetail::DetailType> &typesChanged)
 {
-    Q_UNUSED(typesChanged)
+    QList<QContactId> updateIds;
+    QList<QContactId> typedUpdateIds;
 
-    if (m_keepPopulated) {
-        updateContacts(ids, &m_changedContacts);
-    } else {
-        // Update these contacts if they're already in the cache
-        QList<QContactId> presentIds;
-        foreach (const QContactId &id, ids) {
-            if (existingItem(id)) {
-                presentIds.append(id);
+    foreach (const QContactId &id, ids) {
+        CacheItem *item = existingItem(id);
+        if (item && item->contactState != ContactAbsent && !typesChanged.isEmpty()) {
+            // We only need to fetch the changed details of contacts already in the cache
+            typedUpdateIds.append(id);
+        } else if (item || m_keepPopulated) {
+            // Otherwise, update these contacts only if they're already in the cache
+            updateIds.append(id);
+        }
+    }
+
+    updateContacts(updateIds, &m_changedContacts);
+
+    if (!typedUpdateIds.isEmpty()) {
+        QSet<QContactDetail::DetailType> types;
+        foreach (QContactDetail::DetailType type, typesChanged) {
+            types.insert(type);
+        }
+
+        // The display label is derived from the name details, so they must be refreshed together
+        static const DetailList displayTypes(displayDetails());
+        foreach (QContactDetail::DetailType type, displayTypes) {
+            if (types.contains(type)) {
+                foreach (QContactDetail::DetailType displayType, displayTypes) {
+                    types.insert(displayType);
+                }
+                break;
             }
         }
-        updateContacts(presentIds, &m_changedContacts);
+
+        // Coalesce with pending changes to the same detail types
+        QList<QPair<QSet<QContactDetail::DetailType>, QList<QContactId> > >::iterator it = m_typedChangedContacts.begin(),
+                end = m_typedChangedContacts.end();
+        for ( ; it != end; ++it) {
+            if ((*it).first == types) {
+                updateContacts(typedUpdateIds, &(*it).second);
+                break;
+            }
+        }
+        if (it == end) {
+            m_typedChangedContacts.append(qMakePair(types, QList<QContactId>()));
+            updateContacts(typedUpdateIds, &m_typedChangedContacts.last().second);
+        }
     }
 }
 
@@ -2227,7 +2948,10 @@ void SeasideCache::contactsRemoved(const QList<QContactId> &ids)
     }
 
     if (m_keepPopulated) {
-        m_refreshRequired = true;
+        // Remove these contacts from the lists, without resynchronizing the complete lists
+        foreach (const QContactId &id, ids) {
+            m_deltaRemovedIds.insert(internalId(id));
+        }
     } else {
         // Remove these contacts if they're already in the cache; they won't be removed by syncing
         foreach (const QContactId &id, presentIds) {
@@ -2278,14 +3002,8 @@ void SeasideCache::fetchContacts()
         m_fetchTimer.stop();
         m_fetchPostponed.invalidate();
 
-        // Fetch any changed contacts immediately
-        if (m_contactsUpdated) {
-            m_contactsUpdated = false;
-            if (m_keepPopulated) {
-                // Refresh our contact sets in case sorting has changed
-                m_refreshRequired = true;
-            }
-        }
+        // Fetch any changed contacts immediately; their list positions are updated once
+        // their data has been applied
         requestUpdate();
     }
 }
@@ -2299,7 +3017,6 @@ void SeasideCache::updateContacts(const QList<QContactId> &contactIds, QList<QCo
     static const int MaxPostponementMs = 5000;
 
     if (!contactIds.isEmpty()) {
-        m_contactsUpdated = true;
         updateList->append(contactIds);
 
         // If the display is off, defer fetching these changes
@@ -2320,7 +3037,8 @@ void SeasideCache::updateContacts(const QList<QContactId> &contactIds, QList<QCo
     }
 }
 
-void SeasideCache::updateCache(CacheItem *item, const QContact &contact, bool partialFetch, bool initialInsert)
+void SeasideCache::updateCache(CacheItem *item, const QContact &contact, bool partialFetch, bool initialInsert,
+                               const DecodedContact *decoded)
 {
     if (item->contactState < ContactRequested) {
         item->contactState = partialFetch ? ContactPartial : ContactComplete;
@@ -2343,7 +3061,18 @@ void SeasideCache::updateCache(CacheItem *item, const QContact &contact, bool pa
     // non-name details.
     const bool fallbackToNonNameDetails = item->displayLabel.isEmpty();
 
-    const QString displayLabel = generateDisplayLabel(item->contact, displayLabelOrder(), fallbackToNonNameDetails);
+    // Use the label generated by the decode stage, if it was generated from the current name
+    const QContactName name(item->contact.detail<QContactName>());
+    const bool decodedLabel = decoded
+            && !decoded->displayLabel.isEmpty()
+            && decoded->displayLabelOrder == displayLabelOrder()
+            && decoded->firstName == name.firstName()
+            && decoded->lastName == name.lastName()
+            && decoded->labelDetail == item->contact.detail<QContactDisplayLabel>().label();
+
+    const QString displayLabel = decodedLabel
+            ? decoded->displayLabel
+            : generateDisplayLabel(item->contact, displayLabelOrder(), fallbackToNonNameDetails);
     if (!displayLabel.isEmpty()) {
         item->displayLabel = displayLabel;
     }
@@ -2352,11 +3081,264 @@ void SeasideCache::updateCache(CacheItem *item, const QContact &contact, bool pa
         item->displayLabelGroup = displayLabelGroup;
     }
 
+    updateMetadata(item, decoded);
+
+    if (item->contactState == ContactComplete) {
+        recordCompleteContact(item);
+    }
+
     if (!initialInsert) {
         reportItemUpdated(item);
     }
 }
 
+void SeasideCache::recordCompleteContact(CacheItem *item)
+{
+    const int size = estimatedContactSize(item->contact);
+
+    QHash<quint32, QPair<quint64, int> >::iterator it = m_completeContacts.find(item->iid);
+    if (it != m_completeContacts.end()) {
+        m_completeContactOrder.remove(it->first);
+        m_completeContactsSize -= it->second;
+        *it = qMakePair(++m_completeContactTick, size);
+    } else {
+        m_completeContacts.insert(item->iid, qMakePair(++m_completeContactTick, size));
+    }
+
+    m_completeContactOrder.insert(m_completeContactTick, item->iid);
+    m_completeContactsSize += size;
+    m_completeContactsStalled = false;
+
+    if (m_completeContactsSize > completeContactBudgetBytes) {
+        // Demote the least recently used contacts when the cache is next idle
+        requestUpdate();
+    }
+}
+
+void SeasideCache::touchCompleteContact(quint32 iid)
+{
+    QHash<quint32, QPair<quint64, int> >::iterator it = m_completeContacts.find(iid);
+    if (it != m_completeContacts.end()) {
+        m_completeContactOrder.remove(it->first);
+        it->first = ++m_completeContactTick;
+        m_completeContactOrder.insert(m_completeContactTick, iid);
+    }
+}
+
+void SeasideCache::forgetCompleteContact(quint32 iid)
+{
+    QHash<quint32, QPair<quint64, int> >::iterator it = m_completeContacts.find(iid);
+    if (it != m_completeContacts.end()) {
+        m_completeContactOrder.remove(it->first);
+        m_completeContactsSize -= it->second;
+        m_completeContacts.erase(it);
+        m_completeContactsStalled = false;
+    }
+}
+
+static bool hasActiveListener(const SeasideCache::CacheItem *item)
+{
+    for (const SeasideCache::ItemListener *listener = item->listeners; listener; listener = listener->next) {
+        if (listener->isActive())
+            return true;
+    }
+    return false;
+}
+
+void SeasideCache::demoteCompleteContacts()
+{
+    if (m_completeContactsStalled) {
+        // The previous pass found nothing more to demote, and no contact has been completed since
+        return;
+    }
+
+    // Demoted contacts retain every detail type that any list, model or resolution has fetched,
+    // since those types are recorded as loaded and won't be fetched again. Addresses are always
+    // retained, so that demotion never changes what the contact resolves from.
+    const quint32 retainedFetchTypes = m_fetchTypes | m_extraFetchTypes | m_dataTypesFetched
+            | SeasideCache::FetchGender | SeasideCache::FetchAccountUri
+            | SeasideCache::FetchPhoneNumber | SeasideCache::FetchEmailAddress;
+    QSet<QContactDetail::DetailType> retainedTypes;
+    foreach (QContactDetail::DetailType type, detailTypesHint(metadataFetchHint(retainedFetchTypes))) {
+        retainedTypes.insert(type);
+    }
+
+    // The demoted contacts, grouped by the kinds of data they lost
+    QHash<quint32, QList<quint32> > changedIds;
+
+    QMap<quint64, quint32>::iterator it = m_completeContactOrder.begin();
+    while (m_completeContactsSize > completeContactBudgetBytes && it != m_completeContactOrder.end()) {
+        const quint32 iid = it.value();
+
+        CacheItem *item = existingItem(iid);
+        if (item && item->contactState == ContactComplete) {
+            if (hasActiveListener(item) || (item->itemData && item->itemData->isActive())) {
+                // This contact is in use; leave it complete
+                ++it;
+                continue;
+            }
+
+            QContact contact;
+            contact.setId(item->contact.id());
+            contact.setCollectionId(item->contact.collectionId());
+
+            quint32 changes = 0;
+            foreach (const QContactDetail &detail, item->contact.details()) {
+                const QContactDetail::DetailType type(detailType(detail));
+                if (retainedTypes.contains(type)) {
+                    QContactDetail copy(detail);
+                    contact.saveDetail(&copy);
+                } else {
+                    changes |= itemDataChanges(type);
+                }
+            }
+
+            item->contactState = ContactPartial;
+            if (item->itemData) {
+                item->itemData->updateContact(contact, &item->contact, item->contactState);
+            } else {
+                item->contact = contact;
+            }
+            ++m_demotedContactCount;
+
+            if (changes) {
+                changedIds[changes].append(iid);
+            }
+            reportItemUpdated(item);
+        }
+
+        // Contacts no longer complete are recorded again if they are completed
+        QHash<quint32, QPair<quint64, int> >::iterator cit = m_completeContacts.find(iid);
+        m_completeContactsSize -= cit->second;
+        m_completeContacts.erase(cit);
+        it = m_completeContactOrder.erase(it);
+    }
+
+    // If the remaining contacts are all in use, don't scan them again until the set changes
+    m_completeContactsStalled = (m_completeContactsSize > completeContactBudgetBytes);
+
+    for (QHash<quint32, QList<quint32> >::const_iterator cit = changedIds.constBegin(); cit != changedIds.constEnd(); ++cit) {
+        contactDataChanged(cit.value(), FilterFavorites, cit.key());
+        contactDataChanged(cit.value(), FilterAll, cit.key());
+    }
+}
+
+void SeasideCache::invalidateAddressSnapshot()
+{
+    // Publish at most once per interval, rather than for each modification
+    if (!m_addressSnapshotTimer.isActive()) {
+        m_addressSnapshotTimer.start(addressSnapshotInterval, this);
+    }
+}
+
+// The list metadata of the snapshot is maintained as each item changes, so that publication
+// does not need to visit every item
+void SeasideCache::updateSnapshotContact(const CacheItem *item)
+{
+    if (item->contactState == ContactAbsent) {
+        m_snapshotContacts.remove(item->iid);
+        return;
+    }
+
+    // The strings are implicitly shared with the item
+    AddressSnapshot::Contact &contact(m_snapshotContacts[item->iid]);
+    contact.iid = item->iid;
+    contact.displayLabel = item->displayLabel;
+    contact.displayLabelGroup = item->displayLabelGroup;
+    contact.statusFlags = item->statusFlags;
+    contact.favorite = item->contact.detail<QContactFavorite>().isFavorite();
+
+    const QContactGlobalPresence presence(item->contact.detail<QContactGlobalPresence>());
+    contact.presenceState = presence.isEmpty() ? QContactPresence::PresenceUnknown : presence.presenceState();
+}
+
+void SeasideCache::publishAddressSnapshot()
+{
+    m_addressSnapshotTimer.stop();
+
+    // The containers are implicitly shared, so these copies are cheap; the cache detaches its
+    // own instances when it next modifies them, leaving the published data unchanged
+    std::shared_ptr<AddressSnapshot> snapshot(std::make_shared<AddressSnapshot>());
+    snapshot->m_epoch = ++m_addressSnapshotEpoch;
+    snapshot->m_phoneNumbersIndexed = (m_fetchTypes & FetchPhoneNumber) != 0;
+    snapshot->m_phoneNumberIds = m_phoneNumberIds;
+    snapshot->m_emailAddressIds = m_emailAddressIds;
+    snapshot->m_onlineAccountIds = m_onlineAccountIds;
+    snapshot->m_contacts = m_snapshotContacts;
+
+    std::atomic_store(&publishedAddressSnapshot, std::shared_ptr<const AddressSnapshot>(snapshot));
+}
+
+void SeasideCache::updateMetadata(CacheItem *item, const DecodedContact *decoded)
+{
+    invalidateAddressSnapshot();
+    updateSnapshotContact(item);
+
+    // Precompute the collation keys ordering the contact lists, so they can be re-sorted in memory
+    const QContactName name(item->contact.detail<QContactName>());
+    if (decoded
+            && decoded->firstName == name.firstName()
+            && decoded->lastName == name.lastName()
+            && decoded->displayLabel == item->displayLabel) {
+        item->sortKeys = decoded->sortKeys;
+    } else {
+        item->sortKeys = QList<QCollatorSortKey>()
+                << m_sortCollator.sortKey(name.firstName())
+                << m_sortCollator.sortKey(name.lastName())
+                << m_sortCollator.sortKey(item->displayLabel);
+    }
+}
+
+bool SeasideCache::resortContacts()
+{
+    const SortOrderLessThan lessThan(sortProperty() != QLatin1String("firstName"));
+
+    QList<quint32> sortedIds[FilterTypesCount];
+    for (int filter = FilterAll; filter < FilterTypesCount; ++filter) {
+        const QList<quint32> ids(m_contacts[filter].toList());
+
+        QVector<SortEntry> entries;
+        entries.reserve(ids.count());
+        foreach (quint32 iid, ids) {
+            const CacheItem *item = existingItem(iid);
+            if (!item) {
+                // We can't order this contact without its data
+                return false;
+            }
+            entries.append(sortEntry(item, allContactDisplayLabelGroups));
+        }
+
+        parallelSort(entries, lessThan);
+
+        sortedIds[filter].reserve(entries.count());
+        for (const SortEntry &entry : entries) {
+            sortedIds[filter].append(entry.item->iid);
+        }
+        if (sortedIds[filter] == ids) {
+            sortedIds[filter].clear();
+        }
+    }
+
+    for (int filter = FilterAll; filter < FilterTypesCount; ++filter) {
+        if (sortedIds[filter].isEmpty())
+            continue;
+
+        const QList<ListModel *> &models = m_models[filter];
+        for (ListModel *model : models) {
+            model->sourceAboutToChangeLayout();
+        }
+
+        m_contacts[filter] = sortedIds[filter];
+
+        for (ListModel *model : models) {
+            model->sourceLayoutChanged();
+            model->updateSectionBucketIndexCache();
+        }
+    }
+
+    return true;
+}
+
 void SeasideCache::reportItemUpdated(CacheItem *item)
 {
     // Report the change to this contact
@@ -2405,13 +3387,16 @@ void SeasideCache::resolveUnknownAddresses(const QString &first, const QString &
 }
 
 bool SeasideCache::updateContactIndexing(const QContact &oldContact, const QContact &contact, quint32 iid,
-                                         const QSet<QContactDetail::DetailType> &queryDetailTypes, CacheItem *item)
+                                         const QSet<QContactDetail::DetailType> &queryDetailTypes, CacheItem *item,
+                                         const DecodedContact *decoded)
 {
     if (oldContact.collectionId() != aggregateCollectionId()
             && contact.collectionId() != aggregateCollectionId()) {
         return false;
     }
 
+    invalidateAddressSnapshot();
+
     bool modified = false;
 
     QSet<StringPair> oldAddresses;
@@ -2426,8 +3411,24 @@ bool SeasideCache::updateContactIndexing(const QContact &oldContact, const QCont
         }
 
         // Update our address indexes for any address details in this contact
-        foreach (const QContactPhoneNumber &phoneNumber, contact.details<QContactPhoneNumber>()) {
-            foreach (const StringPair &address, addressPairs(phoneNumber)) {
+        const QList<QContactPhoneNumber> phoneNumbers(contact.details<QContactPhoneNumber>());
+        const bool decodedNumbers = decoded && decoded->phoneNumbers.count() == phoneNumbers.count();
+        for (int i = 0; i < phoneNumbers.count(); ++i) {
+            const QContactPhoneNumber &phoneNumber(phoneNumbers.at(i));
+
+            // Use the forms computed by the decode stage, if they were computed for this number
+            const bool decodedNumber = decodedNumbers && decoded->phoneNumbers.at(i) == phoneNumber.number();
+            const QList<StringPair> addresses(decodedNumber ? decoded->phoneNumberAddresses.at(i)
+                                                            : addressPairs(phoneNumber));
+            if (addresses.isEmpty())
+                continue;
+
+            const QString normalized(decodedNumber ? decoded->normalizedPhoneNumbers.at(i)
+                                                   : normalizePhoneNumber(phoneNumber.number()));
+            const ParsedPhoneNumber parsed(decodedNumber ? decoded->parsedPhoneNumbers.at(i)
+                                                         : parsePhoneNumber(normalized));
+
+            foreach (const StringPair &address, addresses) {
                 if (!validAddressPair(address))
                     continue;
 
@@ -2437,7 +3438,7 @@ bool SeasideCache::updateContactIndexing(const QContact &oldContact, const QCont
                     resolveUnknownAddresses(address.first, address.second, item);
                 }
 
-                CachedPhoneNumber cachedPhoneNumber(normalizePhoneNumber(phoneNumber.number()), iid);
+                CachedPhoneNumber cachedPhoneNumber(normalized, parsed, iid);
 
                 if (contact.collectionId() == aggregateCollectionId()) {
                     if (!m_phoneNumberIds.contains(address.second, cachedPhoneNumber))
@@ -2528,6 +3529,11 @@ bool SeasideCache::updateContactIndexing(const QContact &oldContact, const QCont
         }
     }
 
+    if (item) {
+        // The valid online account flag is held in the snapshot metadata
+        updateSnapshotContact(item);
+    }
+
     return modified;
 }
 
@@ -2569,6 +3575,12 @@ void SeasideCache::contactsAvailable()
         }
         m_fetchProcessedCount += contacts.count();
         fetchHint = m_fetchRequest.fetchHint();
+
+        if (!m_deltaFetchIds.isEmpty()) {
+            foreach (const QContact &contact, contacts) {
+                m_deltaFetchIds.remove(internalId(contact));
+            }
+        }
     }
     if (contacts.isEmpty())
         return;
@@ -2584,44 +3596,137 @@ void SeasideCache::contactsAvailable()
         Q_ASSERT(m_populateProgress > Unpopulated && m_populateProgress < Populated);
         FilterType type(m_populateProgress == FetchFavorites ? FilterFavorites
                                                              : FilterAll);
-        QHash<FilterType, QPair<QSet<QContactDetail::DetailType>, QList<QContact> > >::iterator it = m_contactsToAppend.find(type);
+        scheduleDecode(contacts, type, queryDetailTypes);
+    } else {
+        if (request == &m_fetchByIdRequest || (contacts.count() == 1 && m_decodeJobs.isEmpty())) {
+            // Process these results immediately
+            applyContactUpdates(decodeContacts(contacts, displayLabelOrder(), m_sortCollator), queryDetailTypes);
+            // note: can cause out-of-order since this doesn't result in refresh request.  TODO: remove this line?
+            updateSectionBucketIndexCaches();
+        } else {
+            // Add these contacts to the list to be progressively appended, once decoded
+            scheduleDecode(contacts, FilterNone, queryDetailTypes);
+        }
+    }
+}
+
+QList<SeasideCache::DecodedContact> SeasideCache::decodeContacts(const QList<QContact> &contacts,
+                                                                 DisplayLabelOrder order,
+                                                                 const QCollator &collator)
+{
+    // This may run on a worker thread; it must not touch any cache state
+    QList<DecodedContact> decoded;
+    decoded.reserve(contacts.count());
+
+    foreach (const QContact &contact, contacts) {
+        DecodedContact record;
+        record.contact = contact;
+        record.displayLabelOrder = order;
+
+        const QContactName name(contact.detail<QContactName>());
+        record.firstName = name.firstName();
+        record.lastName = name.lastName();
+        record.labelDetail = contact.detail<QContactDisplayLabel>().label();
+
+        // Labels generated from non-name details depend on the cached state, and are left to the cache
+        record.displayLabel = generateDisplayLabel(contact, order, false);
+        record.sortKeys << collator.sortKey(record.firstName)
+                        << collator.sortKey(record.lastName)
+                        << collator.sortKey(record.displayLabel);
+
+        foreach (const QContactPhoneNumber &phoneNumber, contact.details<QContactPhoneNumber>()) {
+            record.phoneNumbers.append(phoneNumber.number());
+            record.normalizedPhoneNumbers.append(normalizePhoneNumber(phoneNumber.number()));
+            record.parsedPhoneNumbers.append(parsePhoneNumber(record.normalizedPhoneNumbers.last()));
+            record.phoneNumberAddresses.append(addressPairs(phoneNumber));
+        }
+
+        decoded.append(record);
+    }
+
+    return decoded;
+}
+
+void SeasideCache::scheduleDecode(const QList<QContact> &contacts, FilterType appendFilter,
+                                  const QSet<QContactDetail::DetailType> &queryDetailTypes)
+{
+    if (QThread::idealThreadCount() < 2) {
+        // There is no other core to offload to
+        queueContacts(decodeContacts(contacts, displayLabelOrder(), m_sortCollator), appendFilter, queryDetailTypes);
+        return;
+    }
+
+    const DisplayLabelOrder order(displayLabelOrder());
+    const QLocale locale(m_sortCollator.locale());
+
+    DecodeJob job;
+    job.watcher = new QFutureWatcher<QList<DecodedContact> >(this);
+    job.appendFilter = appendFilter;
+    job.detailTypes = queryDetailTypes;
+    connect(job.watcher, &QFutureWatcherBase::finished,
+            this, &SeasideCache::contactsDecoded);
+
+    job.watcher->setFuture(QtConcurrent::run([contacts, order, locale]() {
+        // A collator cannot be shared between threads
+        QCollator collator(locale);
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        return decodeContacts(contacts, order, collator);
+    }));
+    m_decodeJobs.append(job);
+}
+
+void SeasideCache::contactsDecoded()
+{
+    // Queue the decoded batches in the order they were fetched
+    while (!m_decodeJobs.isEmpty() && m_decodeJobs.first().watcher->isFinished()) {
+        const DecodeJob job(m_decodeJobs.takeFirst());
+        queueContacts(job.watcher->result(), job.appendFilter, job.detailTypes);
+        job.watcher->deleteLater();
+    }
+}
+
+void SeasideCache::queueContacts(const QList<DecodedContact> &contacts, FilterType appendFilter,
+                                 const QSet<QContactDetail::DetailType> &queryDetailTypes)
+{
+    if (appendFilter != FilterNone) {
+        QHash<FilterType, QPair<QSet<QContactDetail::DetailType>, QList<DecodedContact> > >::iterator it = m_contactsToAppend.find(appendFilter);
         if (it != m_contactsToAppend.end()) {
             // All populate queries have the same detail types, so we can append this list to the existing one
             it.value().second.append(contacts);
         } else {
-            m_contactsToAppend.insert(type, qMakePair(queryDetailTypes, contacts));
+            m_contactsToAppend.insert(appendFilter, qMakePair(queryDetailTypes, contacts));
         }
-        requestUpdate();
     } else {
-        if (contacts.count() == 1 || request == &m_fetchByIdRequest) {
-            // Process these results immediately
-            applyContactUpdates(contacts, queryDetailTypes);
-            // note: can cause out-of-order since this doesn't result in refresh request.  TODO: remove this line?
-            updateSectionBucketIndexCaches();
-        } else {
-            // Add these contacts to the list to be progressively appended
-            QList<QPair<QSet<QContactDetail::DetailType>, QList<QContact> > >::iterator it = m_contactsToUpdate.begin(),
-                    end = m_contactsToUpdate.end();
-            for ( ; it != end; ++it) {
-                if ((*it).first == queryDetailTypes) {
-                    (*it).second.append(contacts);
-                    break;
-                }
-            }
-            if (it == end) {
-                m_contactsToUpdate.append(qMakePair(queryDetailTypes, contacts));
+        QList<QPair<QSet<QContactDetail::DetailType>, QList<DecodedContact> > >::iterator it = m_contactsToUpdate.begin(),
+                end = m_contactsToUpdate.end();
+        for ( ; it != end; ++it) {
+            if ((*it).first == queryDetailTypes) {
+                (*it).second.append(contacts);
+                break;
             }
-
-            requestUpdate();
+        }
+        if (it == end) {
+            m_contactsToUpdate.append(qMakePair(queryDetailTypes, contacts));
         }
     }
+
+    requestUpdate();
+}
+
+bool SeasideCache::decodePending(FilterType appendFilter) const
+{
+    foreach (const DecodeJob &job, m_decodeJobs) {
+        if (job.appendFilter == appendFilter)
+            return true;
+    }
+    return false;
 }
 
 void SeasideCache::applyPendingContactUpdates()
 {
     if (!m_contactsToAppend.isEmpty()) {
         // Insert the contacts in the order they're requested
-        QHash<FilterType, QPair<QSet<QContactDetail::DetailType>, QList<QContact> > >::iterator end = m_contactsToAppend.end(),
+        QHash<FilterType, QPair<QSet<QContactDetail::DetailType>, QList<DecodedContact> > >::iterator end = m_contactsToAppend.end(),
                 it = end;
         if ((it = m_contactsToAppend.find(FilterFavorites)) != end) {
         } else if ((it = m_contactsToAppend.find(FilterAll)) != end) {
@@ -2632,44 +3737,64 @@ void SeasideCache::applyPendingContactUpdates()
         QSet<QContactDetail::DetailType> &detailTypes((*it).first);
         const bool partialFetch = !detailTypes.isEmpty();
 
-        QList<QContact> &appendedContacts((*it).second);
+        QList<DecodedContact> &appendedContacts((*it).second);
+
+        // Append progressively, in batches sized to the time budget
+        const int batchSize = qMin(m_appendBatchSize, appendedContacts.count());
 
-        const int maxBatchSize = 200;
-        const int minBatchSize = 50;
+        QElapsedTimer batchTimer;
+        batchTimer.start();
 
-        if (appendedContacts.count() < maxBatchSize) {
-            // For a small number of contacts, append all at once
+        if (batchSize == appendedContacts.count()) {
             appendContacts(appendedContacts, type, partialFetch, detailTypes);
             appendedContacts.clear();
         } else {
-            // Append progressively in batches
-            appendContacts(appendedContacts.mid(0, minBatchSize), type, partialFetch, detailTypes);
-            appendedContacts = appendedContacts.mid(minBatchSize);
+            appendContacts(appendedContacts.mid(0, batchSize), type, partialFetch, detailTypes);
+            appendedContacts = appendedContacts.mid(batchSize);
         }
 
+        m_appendBatchSize = nextBatchSize(batchSize, batchTimer.nsecsElapsed(), batchTimeBudgetMs);
+
         if (appendedContacts.isEmpty()) {
             m_contactsToAppend.erase(it);
 
             // This list has been processed - have we finished populating the group?
-            if (type == FilterFavorites && (m_populateProgress != FetchFavorites)) {
+            if (decodePending(type)) {
+                // More contacts of this group are still being decoded
+            } else if (type == FilterFavorites && (m_populateProgress != FetchFavorites)) {
                 makePopulated(FilterFavorites);
                 qDebug() << "Favorites queried in" << m_timer.elapsed() << "ms";
             } else if (type == FilterAll && (m_populateProgress != FetchMetadata)) {
                 makePopulated(FilterNone);
                 makePopulated(FilterAll);
                 qDebug() << "All queried in" << m_timer.elapsed() << "ms";
+
+                m_snapshotState = SnapshotSaveRequired;
             }
             updateSectionBucketIndexCaches();
         }
     } else {
-        QList<QPair<QSet<QContactDetail::DetailType>, QList<QContact> > >::iterator it = m_contactsToUpdate.begin();
+        QList<QPair<QSet<QContactDetail::DetailType>, QList<DecodedContact> > >::iterator it = m_contactsToUpdate.begin();
 
         QSet<QContactDetail::DetailType> &detailTypes((*it).first);
 
-        // Update a single contact at a time; the update can cause numerous QML bindings
-        // to be re-evaluated, so even a single contact update might be a slow operation
-        QList<QContact> &updatedContacts((*it).second);
-        applyContactUpdates(QList<QContact>() << updatedContacts.takeFirst(), detailTypes);
+        // The update can cause numerous QML bindings to be re-evaluated, so even a single
+        // contact update might be a slow operation; size each batch to the time budget
+        QList<DecodedContact> &updatedContacts((*it).second);
+        const int batchSize = qMin(m_updateBatchSize, updatedContacts.count());
+
+        QElapsedTimer batchTimer;
+        batchTimer.start();
+
+        if (batchSize == updatedContacts.count()) {
+            applyContactUpdates(updatedContacts, detailTypes);
+            updatedContacts.clear();
+        } else {
+            applyContactUpdates(updatedContacts.mid(0, batchSize), detailTypes);
+            updatedContacts = updatedContacts.mid(batchSize);
+        }
+
+        m_updateBatchSize = nextBatchSize(batchSize, batchTimer.nsecsElapsed(), batchTimeBudgetMs);
 
         if (updatedContacts.isEmpty()) {
             m_contactsToUpdate.erase(it);
@@ -2688,19 +3813,24 @@ void SeasideCache::updateSectionBucketIndexCaches()
     }
 }
 
-void SeasideCache::applyContactUpdates(const QList<QContact> &contacts,
+void SeasideCache::applyContactUpdates(const QList<DecodedContact> &contacts,
                                        const QSet<QContactDetail::DetailType> &queryDetailTypes)
 {
     QSet<QString> modifiedGroups;
+    QMap<quint32, QList<quint32> > changedIds;
     const bool partialFetch = !queryDetailTypes.isEmpty();
 
-    foreach (QContact contact, contacts) {
+    foreach (const DecodedContact &decoded, contacts) {
+        QContact contact(decoded.contact);
         quint32 iid = internalId(contact);
 
         QString oldDisplayLabelGroup;
         QString oldDisplayLabel;
+        QContactName oldName;
+        bool oldFavorite = false;
 
         CacheItem *item = existingItem(iid);
+        const bool newItem = !item;
         if (!item) {
             // We haven't seen this contact before
             item = &(m_people[iid]);
@@ -2708,6 +3838,8 @@ void SeasideCache::applyContactUpdates(const QList<QContact> &contacts,
         } else {
             oldDisplayLabelGroup = item->displayLabelGroup;
             oldDisplayLabel = item->displayLabel;
+            oldName = item->contact.detail<QContactName>();
+            oldFavorite = item->contact.detail<QContactFavorite>().isFavorite();
 
             if (partialFetch) {
                 // Update our new instance with any details not returned by the current query
@@ -2716,6 +3848,16 @@ void SeasideCache::applyContactUpdates(const QList<QContact> &contacts,
         }
 
         bool roleDataChanged = false;
+        quint32 changes = 0;
+
+        if (partialFetch) {
+            // Only the queried details can have changed
+            foreach (QContactDetail::DetailType type, queryDetailTypes) {
+                if (contact.details(type) != item->contact.details(type)) {
+                    changes |= itemDataChanges(type);
+                }
+            }
+        }
 
         // This is a simplification of reality, should we test more changes?
         if (!partialFetch || queryDetailTypes.contains(detailType<QContactAvatar>())) {
@@ -2725,10 +3867,16 @@ void SeasideCache::applyContactUpdates(const QList<QContact> &contacts,
             roleDataChanged |= (contact.detail<QContactGlobalPresence>() != item->contact.detail<QContactGlobalPresence>());
         }
 
-        roleDataChanged |= updateContactIndexing(item->contact, contact, iid, queryDetailTypes, item);
+        if (updateContactIndexing(item->contact, contact, iid, queryDetailTypes, item, &decoded)) {
+            roleDataChanged = true;
+            changes |= AddressDataChanged;
+        }
 
-        updateCache(item, contact, partialFetch, false);
-        roleDataChanged |= (item->displayLabel != oldDisplayLabel);
+        updateCache(item, contact, partialFetch, false, &decoded);
+        if (item->displayLabel != oldDisplayLabel || item->displayLabelGroup != oldDisplayLabelGroup) {
+            roleDataChanged = true;
+            changes |= NameDataChanged;
+        }
 
         // do this even if !roleDataChanged as name groups are affected by other display label changes
         if (item->displayLabelGroup != oldDisplayLabelGroup) {
@@ -2738,9 +3886,29 @@ void SeasideCache::applyContactUpdates(const QList<QContact> &contacts,
             }
         }
 
-        if (roleDataChanged) {
-            instancePtr->contactDataChanged(item->iid);
+        // A complete fetch could have changed any of the item's data
+        if (!partialFetch && roleDataChanged) {
+            changes = AllDataChanged;
+        }
+        if (changes) {
+            changedIds[changes].append(item->iid);
         }
+
+        if (m_keepPopulated && m_populateProgress == Populated) {
+            // If the properties determining list membership or order have changed, the contact must be placed
+            if (newItem
+                    || item->displayLabelGroup != oldDisplayLabelGroup
+                    || item->contact.detail<QContactName>() != oldName
+                    || item->contact.detail<QContactFavorite>().isFavorite() != oldFavorite
+                    || contactIndex(iid, FilterAll) == -1) {
+                m_deltaSyncIds.insert(iid);
+            }
+        }
+    }
+
+    for (QMap<quint32, QList<quint32> >::const_iterator it = changedIds.constBegin(); it != changedIds.constEnd(); ++it) {
+        contactDataChanged(it.value(), FilterFavorites, it.key());
+        contactDataChanged(it.value(), FilterAll, it.key());
     }
 
     notifyDisplayLabelGroupsChanged(modifiedGroups);
@@ -2810,21 +3978,21 @@ void SeasideCache::relationshipsAvailable()
 
 void SeasideCache::removeRange(FilterType filter, int index, int count)
 {
-    QList<quint32> &cacheIds = m_contacts[filter];
+    SeasideContactIdList &cacheIds = m_contacts[filter];
     QList<ListModel *> &models = m_models[filter];
 
     for (int i = 0; i < models.count(); ++i)
         models[i]->sourceAboutToRemoveItems(index, index + count - 1);
 
-    for (int i = 0; i < count; ++i) {
-        if (filter == FilterAll) {
-            const quint32 iid = cacheIds.at(index);
+    if (filter == FilterAll) {
+        for (int i = 0; i < count; ++i) {
+            const quint32 iid = cacheIds.at(index + i);
             m_expiredContacts[apiId(iid)] -= 1;
         }
-
-        cacheIds.removeAt(index);
     }
 
+    cacheIds.remove(index, count);
+
     for (int i = 0; i < models.count(); ++i) {
         models[i]->sourceItemsRemoved();
         models[i]->updateSectionBucketIndexCache();
@@ -2833,7 +4001,7 @@ void SeasideCache::removeRange(FilterType filter, int index, int count)
 
 int SeasideCache::insertRange(FilterType filter, int index, int count, const QList<quint32> &queryIds, int queryIndex)
 {
-    QList<quint32> &cacheIds = m_contacts[filter];
+    SeasideContactIdList &cacheIds = m_contacts[filter];
     QList<ListModel *> &models = m_models[filter];
 
     const quint32 selfId = internalId(manager()->selfContactId());
@@ -2863,15 +4031,13 @@ int SeasideCache::insertRange(FilterType filter, int index, int count, const QLi
     return end - index + 1;
 }
 
-void SeasideCache::appendContacts(const QList<QContact> &contacts, FilterType filterType, bool partialFetch,
+void SeasideCache::appendContacts(const QList<DecodedContact> &contacts, FilterType filterType, bool partialFetch,
                                   const QSet<QContactDetail::DetailType> &queryDetailTypes)
 {
     if (!contacts.isEmpty()) {
-        QList<quint32> &cacheIds = m_contacts[filterType];
+        SeasideContactIdList &cacheIds = m_contacts[filterType];
         QList<ListModel *> &models = m_models[filterType];
 
-        cacheIds.reserve(contacts.count());
-
         const int begin = cacheIds.count();
         int end = cacheIds.count() + contacts.count() - 1;
 
@@ -2881,7 +4047,8 @@ void SeasideCache::appendContacts(const QList<QContact> &contacts, FilterType fi
             for (int i = 0; i < models.count(); ++i)
                 models.at(i)->sourceAboutToInsertItems(begin, end);
 
-            foreach (QContact contact, contacts) {
+            foreach (const DecodedContact &decoded, contacts) {
+                QContact contact(decoded.contact);
                 quint32 iid = internalId(contact);
                 cacheIds.append(iid);
 
@@ -2896,8 +4063,8 @@ void SeasideCache::appendContacts(const QList<QContact> &contacts, FilterType fi
                     }
                 }
 
-                updateContactIndexing(item->contact, contact, iid, queryDetailTypes, item);
-                updateCache(item, contact, partialFetch, true);
+                updateContactIndexing(item->contact, contact, iid, queryDetailTypes, item, &decoded);
+                updateCache(item, contact, partialFetch, true, &decoded);
 
                 if (filterType == FilterAll) {
                     addToContactDisplayLabelGroup(iid, displayLabelGroup(item), &modifiedGroups);
@@ -3049,7 +4216,8 @@ void SeasideCache::requestStateChanged(QContactAbstractRequest::State state)
         if (m_populating) {
             Q_ASSERT(m_populateProgress > Unpopulated && m_populateProgress < Populated);
             if (m_populateProgress == FetchFavorites) {
-                if (m_contactsToAppend.find(FilterFavorites) == m_contactsToAppend.end()) {
+                if (m_contactsToAppend.find(FilterFavorites) == m_contactsToAppend.end()
+                        && !decodePending(FilterFavorites)) {
                     // No pending contacts, the models are now populated
                     makePopulated(FilterFavorites);
                     qDebug() << "Favorites queried in" << m_timer.elapsed() << "ms";
@@ -3057,15 +4225,24 @@ void SeasideCache::requestStateChanged(QContactAbstractRequest::State state)
 
                 m_populateProgress = FetchMetadata;
             } else if (m_populateProgress == FetchMetadata) {
-                if (m_contactsToAppend.find(FilterAll) == m_contactsToAppend.end()) {
+                if (m_contactsToAppend.find(FilterAll) == m_contactsToAppend.end()
+                        && !decodePending(FilterAll)) {
                     makePopulated(FilterNone);
                     makePopulated(FilterAll);
                     qDebug() << "All queried in" << m_timer.elapsed() << "ms";
+
+                    m_snapshotState = SnapshotSaveRequired;
                 }
 
                 m_populateProgress = Populated;
             }
             m_populating = false;
+        } else if (!m_deltaFetchIds.isEmpty()) {
+            if (request->error() == QContactManager::NoError) {
+                // Changed contacts that were not returned are no longer listed aggregates
+                m_deltaRemovedIds += m_deltaFetchIds;
+            }
+            m_deltaFetchIds.clear();
         }
     } else if (request == &m_saveRequest) {
         for (int i = 0; i < m_saveRequest.contacts().size(); ++i) {
@@ -3118,7 +4295,40 @@ void SeasideCache::addressRequestStateChanged(QContactAbstractRequest::State sta
 #else
     QSet<QContactDetail::DetailType> queryDetailTypes = detailTypesHint(request->fetchHint()).toSet();
 #endif
-    applyContactUpdates(request->contacts(), queryDetailTypes);
+    applyContactUpdates(decodeContacts(request->contacts(), displayLabelOrder(), m_sortCollator), queryDetailTypes);
+
+    QHash<QContactFetchRequest *, QList<ResolveData> >::iterator bit = m_resolveAddressBatches.find(request);
+    if (bit != m_resolveAddressBatches.end()) {
+        QList<ResolveData> batch(bit.value());
+        m_resolveAddressBatches.erase(bit);
+
+        // The fetched contacts may match any of the addresses, so each is sought in the updated indexes
+        QList<CacheItem *> items;
+        for (QList<ResolveData>::iterator it = batch.begin(); it != batch.end(); ++it) {
+            if (it->first == QString()) {
+                // We have now queried this phone number
+                m_resolvedPhoneNumbers.insert(minimizePhoneNumber(it->second));
+            }
+
+            CacheItem *item = resolvedItem(it->first, it->second);
+            if (!item) {
+                // This address is unknown - keep it for later resolution
+                it->compare = unknownAddressCompare(it->first, it->second);
+                m_unknownAddresses.append(*it);
+            }
+            items.append(item);
+            m_pendingResolve.remove(*it);
+        }
+
+        ResolveListener *listener = batch.first().listener;
+        for (int i = 0; i < batch.count(); ++i) {
+            listener->addressResolved(batch.at(i).first, batch.at(i).second, items.at(i));
+        }
+        listener->addressBatchResolved();
+
+        delete request;
+        return;
+    }
 
     // now figure out which address was being resolved and resolve it
     QHash<QContactFetchRequest *, ResolveData>::iterator it = instancePtr->m_resolveAddresses.find(request);
@@ -3143,27 +4353,11 @@ void SeasideCache::addressRequestStateChanged(QContactAbstractRequest::State sta
             item = itemById(apiId(resolvedContacts.first()), false);
         } else {
             // Lookup the result in our updated indexes
-            if (data.first == QString()) {
-                item = itemByPhoneNumber(data.second, false);
-            } else if (data.second == QString()) {
-                item = itemByEmailAddress(data.first, false);
-            } else {
-                item = itemByOnlineAccount(data.first, data.second, false);
-            }
+            item = resolvedItem(data.first, data.second);
         }
     } else {
         // This address is unknown - keep it for later resolution
-        if (data.first == QString()) {
-            // Compare this phone number in minimized form
-            data.compare = minimizePhoneNumber(data.second);
-        } else if (data.second == QString()) {
-            // Compare this email address in lowercased form
-            data.compare = data.first.toLower();
-        } else {
-            // Compare this account URI in lowercased form
-            data.compare = data.second.toLower();
-        }
-
+        data.compare = unknownAddressCompare(data.first, data.second);
         m_unknownAddresses.append(data);
     }
     m_pendingResolve.remove(data);
@@ -3186,6 +4380,218 @@ void SeasideCache::makePopulated(FilterType filter)
     }
 }
 
+bool SeasideCache::loadSnapshot()
+{
+    if (!snapshotEnabled() || !m_contacts[FilterAll].isEmpty() || !m_contacts[FilterFavorites].isEmpty())
+        return false;
+
+    QFile file(snapshotPath());
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    // Decode directly from the mapped file, rather than copying its content
+    const qint64 size = file.size();
+    uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data) {
+        qWarning() << "Unable to map cache snapshot:" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    const QByteArray buffer(QByteArray::fromRawData(reinterpret_cast<const char *>(data), size));
+    QDataStream in(buffer);
+    in.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != snapshotMagic || version != snapshotVersion) {
+        file.unmap(data);
+        return false;
+    }
+
+    QString managerUri;
+    QString localeName;
+    QString snapshotSortProperty;
+    QString snapshotGroupProperty;
+    qint32 snapshotDisplayLabelOrder = 0;
+    quint32 snapshotTypes = 0;
+    in >> managerUri >> localeName >> snapshotSortProperty >> snapshotGroupProperty
+       >> snapshotDisplayLabelOrder >> snapshotTypes;
+
+    // The order, labels and groups of the snapshot must match those we would fetch
+    if (in.status() != QDataStream::Ok
+            || managerUri != manager()->managerUri()
+            || localeName != QLocale().name()
+            || snapshotSortProperty != sortProperty()
+            || snapshotGroupProperty != groupProperty()
+            || snapshotDisplayLabelOrder != displayLabelOrder()) {
+        file.unmap(data);
+        return false;
+    }
+
+    const QContactCollectionId aggregateId(aggregateCollectionId());
+
+    quint32 itemCount = 0;
+    in >> itemCount;
+
+    QList<CacheItem> items;
+    items.reserve(itemCount);
+    for (quint32 i = 0; i < itemCount && in.status() == QDataStream::Ok; ++i) {
+        CacheItem item;
+        quint32 detailCount = 0;
+        in >> item.iid >> item.statusFlags >> item.displayLabel >> item.displayLabelGroup >> detailCount;
+
+        item.contact.setId(apiId(item.iid));
+        item.contact.setCollectionId(aggregateId);
+        item.contactState = ContactPartial;
+
+        for (quint32 j = 0; j < detailCount && in.status() == QDataStream::Ok; ++j) {
+            quint32 type = 0;
+            QMap<int, QVariant> values;
+            in >> type >> values;
+
+            QContactDetail detail(static_cast<QContactDetail::DetailType>(type));
+            for (QMap<int, QVariant>::const_iterator it = values.constBegin(); it != values.constEnd(); ++it) {
+                detail.setValue(it.key(), it.value());
+            }
+            item.contact.saveDetail(&detail);
+        }
+
+        items.append(item);
+    }
+
+    QList<quint32> allIds;
+    QList<quint32> favoriteIds;
+    in >> allIds >> favoriteIds;
+
+    const bool valid = (in.status() == QDataStream::Ok);
+    file.unmap(data);
+
+    if (!valid) {
+        qWarning() << "Ignoring invalid cache snapshot:" << file.fileName();
+        return false;
+    }
+
+    QSet<QString> modifiedGroups;
+
+    foreach (const CacheItem &snapshotItem, items) {
+        QHash<quint32, CacheItem>::iterator it = m_people.find(snapshotItem.iid);
+        if (it != m_people.end() && it->contactState != ContactAbsent) {
+            // We already have more current data for this contact
+            continue;
+        }
+
+        CacheItem *item = &(m_people[snapshotItem.iid]);
+        item->iid = snapshotItem.iid;
+        item->statusFlags = snapshotItem.statusFlags;
+        item->contactState = snapshotItem.contactState;
+        item->displayLabel = snapshotItem.displayLabel;
+        item->displayLabelGroup = snapshotItem.displayLabelGroup;
+
+        updateContactIndexing(item->contact, snapshotItem.contact, item->iid, QSet<QContactDetail::DetailType>(), item);
+        if (item->itemData) {
+            item->itemData->updateContact(snapshotItem.contact, &item->contact, item->contactState);
+        } else {
+            item->contact = snapshotItem.contact;
+        }
+        updateMetadata(item);
+    }
+
+    foreach (quint32 iid, allIds) {
+        if (CacheItem *item = existingItem(iid)) {
+            m_contacts[FilterAll].append(iid);
+            if (!ignoreContactForDisplayLabelGroups(item->contact)) {
+                addToContactDisplayLabelGroup(iid, item->displayLabelGroup, &modifiedGroups);
+            }
+        }
+    }
+    foreach (quint32 iid, favoriteIds) {
+        if (existingItem(iid)) {
+            m_contacts[FilterFavorites].append(iid);
+        }
+    }
+
+    notifyDisplayLabelGroupsChanged(modifiedGroups);
+
+    m_dataTypesFetched |= (snapshotTypes & snapshotFetchTypes);
+    m_populateProgress = Populated;
+    m_populated |= (1 << FilterNone) | (1 << FilterAll) | (1 << FilterFavorites);
+    emit populatedChanged();
+
+    qDebug() << "Snapshot restored in" << m_timer.elapsed() << "ms";
+    return true;
+}
+
+void SeasideCache::saveSnapshot()
+{
+    if (!snapshotEnabled())
+        return;
+
+    // Processes without write access to the database directory can't store a snapshot;
+    // report that once, rather than after each population
+    static bool writable = true;
+    if (!writable)
+        return;
+
+    const QString path(snapshotPath());
+    const QString directory(QFileInfo(path).absolutePath());
+    if (!QDir().mkpath(directory) || !QFileInfo(directory).isWritable()) {
+        qWarning() << "Unable to write cache snapshot, snapshots disabled:" << path;
+        writable = false;
+        return;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write cache snapshot, snapshots disabled:" << path << file.errorString();
+        writable = false;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+
+    out << snapshotMagic << snapshotVersion;
+    out << manager()->managerUri() << QLocale().name() << sortProperty() << groupProperty()
+        << static_cast<qint32>(displayLabelOrder()) << (m_dataTypesFetched & snapshotFetchTypes);
+
+    static const DetailList types(snapshotDetails());
+
+    // Favorites are also members of the complete list, so all items are found there
+    const QList<quint32> allIds(m_contacts[FilterAll].toList());
+
+    QList<const CacheItem *> items;
+    items.reserve(allIds.count());
+    foreach (quint32 iid, allIds) {
+        QHash<quint32, CacheItem>::const_iterator it = m_people.constFind(iid);
+        if (it != m_people.constEnd()) {
+            items.append(&(*it));
+        }
+    }
+
+    out << static_cast<quint32>(items.count());
+    foreach (const CacheItem *item, items) {
+        QList<QContactDetail> details;
+        foreach (const QContactDetail &detail, item->contact.details()) {
+            if (types.contains(detailType(detail))) {
+                details.append(detail);
+            }
+        }
+
+        out << item->iid << item->statusFlags << item->displayLabel << item->displayLabelGroup
+            << static_cast<quint32>(details.count());
+        foreach (const QContactDetail &detail, details) {
+            out << static_cast<quint32>(detailType(detail)) << snapshotValues(detail);
+        }
+    }
+
+    out << allIds << m_contacts[FilterFavorites].toList();
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Unable to write cache snapshot:" << path << file.errorString();
+    }
+}
+
 void SeasideCache::setSortOrder(const QString &property)
 {
     bool firstNameFirst = (property == QString::fromLatin1("firstName"));
@@ -3226,6 +4632,7 @@ void SeasideCache::displayLabelOrderChanged(CacheConfiguration::DisplayLabelOrde
         QString newLabel = generateDisplayLabel(it->contact, static_cast<DisplayLabelOrder>(order));
         if (newLabel != it->displayLabel) {
             it->displayLabel = newLabel;
+            updateMetadata(&*it);
 
             contactDataChanged(it->iid);
             reportItemUpdated(&*it);
@@ -3248,8 +4655,26 @@ void SeasideCache::displayLabelOrderChanged(CacheConfiguration::DisplayLabelOrde
 
 void SeasideCache::displayLabelGroupsChanged(const QStringList &groups)
 {
+    const bool changed = !allContactDisplayLabelGroups.isEmpty() && groups != allContactDisplayLabelGroups;
+
     allContactDisplayLabelGroups = groups;
     contactDisplayLabelGroupCount = groups.count();
+
+    if (changed) {
+        // The groups change with the locale, which also changes the collation order
+        if (m_sortCollator.locale() != QLocale()) {
+            m_sortCollator.setLocale(QLocale());
+
+            typedef QHash<quint32, CacheItem>::iterator iterator;
+            for (iterator it = m_people.begin(); it != m_people.end(); ++it) {
+                if (it->contactState != ContactAbsent) {
+                    updateMetadata(&*it);
+                }
+            }
+        }
+
+        reorderContacts();
+    }
 }
 
 void SeasideCache::sortPropertyChanged(const QString &sortProperty)
@@ -3264,9 +4689,18 @@ void SeasideCache::sortPropertyChanged(const QString &sortProperty)
         }
     }
 
-    // Update the sorted list order
-    m_refreshRequired = true;
-    requestUpdate();
+    reorderContacts();
+}
+
+void SeasideCache::reorderContacts()
+{
+    // Update the sorted list order; if the lists are complete, they can be re-sorted in memory
+    const bool synchronized = m_keepPopulated && m_populateProgress == Populated
+            && m_syncFilter == FilterNone && !m_refreshRequired;
+    if (!synchronized || !resortContacts()) {
+        m_refreshRequired = true;
+        requestUpdate();
+    }
 }
 
 void SeasideCache::displayStatusChanged(const QString &status)
@@ -3280,6 +4714,7 @@ void SeasideCache::displayStatusChanged(const QString &status)
             // The display has been enabled; check for pending fetches
             requestUpdate();
         }
+        emit displayStateChanged();
     }
 #endif
 }
@@ -3399,6 +4834,13 @@ void SeasideCache::keepPopulated(quint32 requiredTypes, quint32 extraTypes)
     if (!m_keepPopulated) {
         m_keepPopulated = true;
         updateRequired = true;
+
+        // Restore the content from the previous session, so that models can be shown
+        // immediately; the restored content is reconciled with the database in the background
+        if (m_populateProgress == Unpopulated && loadSnapshot()) {
+            m_snapshotState = SnapshotRefreshFavorites;
+            m_refreshRequired = true;
+        }
     }
 
     if (updateRequired) {
@@ -3491,64 +4933,112 @@ void SeasideCache::resolveAddress(ResolveListener *listener, const QString &firs
     if (m_pendingResolve.find(data) != m_pendingResolve.end())
         return;
 
-    // Is this address a known-unknown?
-    bool knownUnknown = false;
-    QList<ResolveData>::const_iterator it = instancePtr->m_unknownAddresses.constBegin(), end = m_unknownAddresses.constEnd();
-    for ( ; it != end; ++it) {
-        if (it->first == first && it->second == second) {
-            knownUnknown = true;
-            break;
-        }
-    }
-
-    if (knownUnknown) {
+    if (isKnownUnknownAddress(first, second)) {
         m_unknownResolveAddresses.append(data);
         requestUpdate();
     } else {
-        QContactFetchRequest *request = new QContactFetchRequest(this);
-        request->setManager(manager());
-
-        if (first.isEmpty()) {
-            // Search for phone number
-            request->setFilter(QContactPhoneNumber::match(second));
-        } else if (second.isEmpty()) {
-            // Search for email address
-            QContactDetailFilter detailFilter;
-            setDetailType<QContactEmailAddress>(detailFilter, QContactEmailAddress::FieldEmailAddress);
-            detailFilter.setMatchFlags(QContactFilter::MatchExactly | QContactFilter::MatchFixedString); // allow case insensitive
-            detailFilter.setValue(first);
-
-            request->setFilter(detailFilter);
-        } else {
-            // Search for online account
-            QContactDetailFilter localFilter;
-            setDetailType<QContactOnlineAccount>(localFilter, QContactOnlineAccount__FieldAccountPath);
-            localFilter.setValue(first);
-
-            QContactDetailFilter remoteFilter;
-            setDetailType<QContactOnlineAccount>(remoteFilter, QContactOnlineAccount::FieldAccountUri);
-            remoteFilter.setMatchFlags(QContactFilter::MatchExactly | QContactFilter::MatchFixedString); // allow case insensitive
-            remoteFilter.setValue(second);
-
-            request->setFilter(localFilter & remoteFilter);
-        }
-
-        // If completion is not required, at least include the contact endpoint details (since resolving is obviously being used)
-        const quint32 detailFetchTypes(SeasideCache::FetchAccountUri
-                                       | SeasideCache::FetchPhoneNumber
-                                       | SeasideCache::FetchEmailAddress);
-        request->setFetchHint(requireComplete ? basicFetchHint()
-                                              : onlineFetchHint(m_fetchTypes | m_extraFetchTypes | detailFetchTypes));
-        connect(request, SIGNAL(stateChanged(QContactAbstractRequest::State)),
-            this, SLOT(addressRequestStateChanged(QContactAbstractRequest::State)));
+        QContactFetchRequest *request = resolveRequest(resolveFilter(first, second), requireComplete);
         m_resolveAddresses[request] = data;
         m_pendingResolve.insert(data);
 
-        request->setFilter(request->filter() & aggregateFilter());
         request->start();
     }
 }
 
+void SeasideCache::resolveAddressBatch(const QList<ResolveData> &batch)
+{
+    // A single query matching any of the addresses
+    QContactUnionFilter filter;
+    foreach (const ResolveData &data, batch) {
+        filter.append(resolveFilter(data.first, data.second));
+        m_pendingResolve.insert(data);
+    }
+
+    QContactFetchRequest *request = resolveRequest(filter, batch.first().requireComplete);
+    m_resolveAddressBatches.insert(request, batch);
+
+    request->start();
+}
+
+bool SeasideCache::isKnownUnknownAddress(const QString &first, const QString &second) const
+{
+    QList<ResolveData>::const_iterator it = m_unknownAddresses.constBegin(), end = m_unknownAddresses.constEnd();
+    for ( ; it != end; ++it) {
+        if (it->first == first && it->second == second)
+            return true;
+    }
+    return false;
+}
+
+QContactFetchRequest *SeasideCache::resolveRequest(const QContactFilter &filter, bool requireComplete)
+{
+    QContactFetchRequest *request = new QContactFetchRequest(this);
+    request->setManager(manager());
+    request->setFilter(filter & aggregateFilter());
+
+    // If completion is not required, at least include the contact endpoint details (since resolving is obviously being used)
+    const quint32 detailFetchTypes(SeasideCache::FetchAccountUri
+                                   | SeasideCache::FetchPhoneNumber
+                                   | SeasideCache::FetchEmailAddress);
+    request->setFetchHint(requireComplete ? basicFetchHint()
+                                          : onlineFetchHint(m_fetchTypes | m_extraFetchTypes | detailFetchTypes));
+    connect(request, SIGNAL(stateChanged(QContactAbstractRequest::State)),
+        this, SLOT(addressRequestStateChanged(QContactAbstractRequest::State)));
+
+    return request;
+}
+
+SeasideCache::CacheItem *SeasideCache::resolvedItem(const QString &first, const QString &second)
+{
+    if (first == QString()) {
+        return itemByPhoneNumber(second, false);
+    } else if (second == QString()) {
+        return itemByEmailAddress(first, false);
+    }
+    return itemByOnlineAccount(first, second, false);
+}
+
+QContactFilter SeasideCache::resolveFilter(const QString &first, const QString &second)
+{
+    if (first.isEmpty()) {
+        // Search for phone number
+        return QContactPhoneNumber::match(second);
+    } else if (second.isEmpty()) {
+        // Search for email address
+        QContactDetailFilter detailFilter;
+        setDetailType<QContactEmailAddress>(detailFilter, QContactEmailAddress::FieldEmailAddress);
+        detailFilter.setMatchFlags(QContactFilter::MatchExactly | QContactFilter::MatchFixedString); // allow case insensitive
+        detailFilter.setValue(first);
+
+        return detailFilter;
+    }
+
+    // Search for online account
+    QContactDetailFilter localFilter;
+    setDetailType<QContactOnlineAccount>(localFilter, QContactOnlineAccount__FieldAccountPath);
+    localFilter.setValue(first);
+
+    QContactDetailFilter remoteFilter;
+    setDetailType<QContactOnlineAccount>(remoteFilter, QContactOnlineAccount::FieldAccountUri);
+    remoteFilter.setMatchFlags(QContactFilter::MatchExactly | QContactFilter::MatchFixedString); // allow case insensitive
+    remoteFilter.setValue(second);
+
+    return localFilter & remoteFilter;
+}
+
+QString SeasideCache::unknownAddressCompare(const QString &first, const QString &second)
+{
+    if (first == QString()) {
+        // Compare this phone number in minimized form
+        return minimizePhoneNumber(second);
+    } else if (second == QString()) {
+        // Compare this email address in lowercased form
+        return first.toLower();
+    }
+    // Compare this account URI in lowercased form
+    return second.toLower();
+}
+
 SeasideCache::CacheItem *SeasideCache::itemMatchingPhoneNumber(const QString &number, const QString &normalized,
                                                                bool requireComplete)
 {
@@ -3558,8 +5048,7 @@ SeasideCache::CacheItem *SeasideCache::itemMatchingPhoneNumber(const QString &nu
         return nullptr;
 
     QHash<QString, quint32> possibleMatches;
-    ::i18n::phonenumbers::PhoneNumberUtil *util = ::i18n::phonenumbers::PhoneNumberUtil::GetInstance();
-    ::std::string normalizedStdStr = normalized.toStdString();
+    PhoneNumberMatcher matcher(normalized);
 
     for (QMultiHash<QString, CachedPhoneNumber>::const_iterator matchingIt = it;
          matchingIt != end && matchingIt.key() == number;
@@ -3571,15 +5060,12 @@ SeasideCache::CacheItem *SeasideCache::itemMatchingPhoneNumber(const QString &nu
         if (matchingIt->normalizedNumber == normalized)
             return itemById(cachedPhoneNumber.iid, requireComplete);
 
-        ::i18n::phonenumbers::PhoneNumberUtil::MatchType matchType =
-                util->IsNumberMatchWithTwoStrings(normalizedStdStr, cachedPhoneNumber.normalizedNumber.toStdString());
-
-        switch (matchType) {
-        case ::i18n::phonenumbers::PhoneNumberUtil::EXACT_MATCH:
+        switch (matcher.match(cachedPhoneNumber)) {
+        case PhoneNumberUtil::EXACT_MATCH:
             // This is the optimal outcome
             return itemById(cachedPhoneNumber.iid, requireComplete);
-        case ::i18n::phonenumbers::PhoneNumberUtil::NSN_MATCH:
-        case ::i18n::phonenumbers::PhoneNumberUtil::SHORT_NSN_MATCH:
+        case PhoneNumberUtil::NSN_MATCH:
+        case PhoneNumberUtil::SHORT_NSN_MATCH:
             // Store numbers whose NSN (national significant number) might match
             // Example: if +36701234567 is calling, then 1234567 is an NSN match
             possibleMatches.insert(cachedPhoneNumber.normalizedNumber, cachedPhoneNumber.iid);
@@ -3621,10 +5107,154 @@ SeasideCache::CacheItem *SeasideCache::itemMatchingPhoneNumber(const QString &nu
 
 }
 
+quint32 SeasideCache::AddressSnapshot::matchingPhoneNumber(const QString &number, const QString &normalized) const
+{
+    QMultiHash<QString, CachedPhoneNumber>::const_iterator it = m_phoneNumberIds.constFind(number),
+            end = m_phoneNumberIds.constEnd();
+    if (it == end)
+        return 0;
+
+    PhoneNumberMatcher matcher(normalized);
+
+    // The snapshot has no contact details, so possible matches are ranked by the indexed number
+    int bestMatchLength = 0;
+    quint32 matchIid = 0;
+
+    for ( ; it != end && it.key() == number; ++it) {
+        const CachedPhoneNumber &cachedPhoneNumber = it.value();
+
+        // Bypass libphonenumber if the numbers match exactly
+        if (cachedPhoneNumber.normalizedNumber == normalized)
+            return cachedPhoneNumber.iid;
+
+        switch (matcher.match(cachedPhoneNumber)) {
+        case PhoneNumberUtil::EXACT_MATCH:
+            return cachedPhoneNumber.iid;
+        case PhoneNumberUtil::NSN_MATCH:
+        case PhoneNumberUtil::SHORT_NSN_MATCH: {
+            const int length = matchLength(cachedPhoneNumber.normalizedNumber, normalized);
+            if (length > bestMatchLength) {
+                bestMatchLength = length;
+                matchIid = cachedPhoneNumber.iid;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return matchIid;
+}
+
 int SeasideCache::contactIndex(quint32 iid, FilterType filterType)
 {
-    const QList<quint32> &cacheIds(m_contacts[filterType]);
-    return cacheIds.indexOf(iid);
+    return m_contacts[filterType].indexOf(iid);
+}
+
+bool SeasideCache::placeContact(quint32 iid, FilterType filter, bool member)
+{
+    const int index = contactIndex(iid, filter);
+    if (!member) {
+        if (index == -1)
+            return false;
+
+        removeRange(filter, index, 1);
+        return true;
+    }
+
+    const SeasideContactIdList &cacheIds(m_contacts[filter]);
+    const SortOrderLessThan lessThan(sortProperty() != QLatin1String("firstName"));
+    const SortEntry entry(sortEntry(existingItem(iid), allContactDisplayLabelGroups));
+
+    // Contacts whose data is not yet loaded can't be ordered, so they are skipped over
+    // in favour of the nearest loaded contact in the given direction
+    auto nearestItem = [&cacheIds](int position, int step, int limit, int *found) -> const CacheItem * {
+        for (; position != limit; position += step) {
+            if (const CacheItem *item = existingItem(cacheIds.at(position))) {
+                *found = position;
+                return item;
+            }
+        }
+        return nullptr;
+    };
+
+    if (index != -1) {
+        // Leave the contact in place if it is still ordered correctly relative to its neighbours
+        int position = -1;
+        const CacheItem *previous = nearestItem(index - 1, -1, -1, &position);
+        const CacheItem *next = nearestItem(index + 1, 1, cacheIds.count(), &position);
+        if ((!previous || !lessThan(entry, sortEntry(previous, allContactDisplayLabelGroups)))
+                && (!next || !lessThan(sortEntry(next, allContactDisplayLabelGroups), entry))) {
+            return false;
+        }
+
+        removeRange(filter, index, 1);
+    }
+
+    // Find the position following all items that do not sort after this one
+    int begin = 0;
+    int end = cacheIds.count();
+    while (begin < end) {
+        const int mid = begin + (end - begin) / 2;
+        int position = -1;
+        const CacheItem *other = nearestItem(mid, 1, end, &position);
+        if (!other) {
+            // Nothing between here and the end of the range can be ordered
+            end = mid;
+        } else if (!lessThan(entry, sortEntry(other, allContactDisplayLabelGroups))) {
+            begin = position + 1;
+        } else {
+            end = mid;
+        }
+    }
+
+    insertRange(filter, begin, 1, QList<quint32>() << iid, 0);
+    return true;
+}
+
+void SeasideCache::applyDeltaSync()
+{
+    // Beyond this many changes, synchronizing the complete lists is cheaper
+    static const int maxDeltaIds = 500;
+
+    if (m_deltaSyncIds.count() + m_deltaRemovedIds.count() > maxDeltaIds) {
+        m_deltaSyncIds.clear();
+        m_deltaRemovedIds.clear();
+        m_refreshRequired = true;
+        requestUpdate();
+        return;
+    }
+
+    const quint32 selfId = internalId(manager()->selfContactId());
+    bool favoritesChanged = false;
+    bool allChanged = false;
+
+    foreach (quint32 iid, m_deltaRemovedIds) {
+        m_deltaSyncIds.remove(iid);
+        favoritesChanged |= placeContact(iid, FilterFavorites, false);
+        allChanged |= placeContact(iid, FilterAll, false);
+    }
+    m_deltaRemovedIds.clear();
+
+    foreach (quint32 iid, m_deltaSyncIds) {
+        const CacheItem *item = existingItem(iid);
+        const bool member = item && item->contactState != ContactAbsent && iid != selfId;
+        const bool favorite = member && item->contact.detail<QContactFavorite>().isFavorite();
+        favoritesChanged |= placeContact(iid, FilterFavorites, favorite);
+        allChanged |= placeContact(iid, FilterAll, member);
+    }
+    m_deltaSyncIds.clear();
+
+    // Filtered models must re-evaluate their content
+    if (favoritesChanged) {
+        foreach (ListModel *model, m_models[FilterFavorites])
+            model->sourceItemsChanged();
+    }
+    if (allChanged) {
+        foreach (ListModel *model, m_models[FilterAll])
+            model->sourceItemsChanged();
+    }
 }
 
 QContactFilter SeasideCache::aggregateFilter() const
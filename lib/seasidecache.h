@@ -35,6 +35,7 @@
 
 #include "contactcacheexport.h"
 #include "cacheconfiguration.h"
+#include "seasidecontactidlist.h"
 
 // qtcontacts-sqlite-extensions
 #include <qtcontacts-extensions.h>
@@ -57,14 +58,19 @@
 #include <QContactCollectionId>
 #include <QContactAvatar>
 
+#include <QCollator>
 #include <QTranslator>
 #include <QBasicTimer>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QSet>
+#include <QVariantMap>
 
 #include <QElapsedTimer>
 #include <QAbstractListModel>
 
+#include <memory>
+
 QTCONTACTS_USE_NAMESPACE
 
 class CONTACTCACHE_EXPORT SeasideDisplayLabelGroupChangeListener
@@ -106,6 +112,17 @@ public:
                           | FetchGender)
     };
 
+    enum ItemDataChange {
+        NameDataChanged = (1 << 0),
+        AvatarDataChanged = (1 << 1),
+        PresenceDataChanged = (1 << 2),
+        FavoriteDataChanged = (1 << 3),
+        AddressDataChanged = (1 << 4),
+        OrganizationDataChanged = (1 << 5),
+        NoteDataChanged = (1 << 6),
+        AllDataChanged = 0xffffffff
+    };
+
     enum DisplayLabelOrder {
         FirstNameFirst = CacheConfiguration::FirstNameFirst,
         LastNameFirst = CacheConfiguration::LastNameFirst
@@ -138,6 +155,10 @@ public:
         virtual void aggregationOperationCompleted() = 0;
 
         virtual QList<int> constituents() const = 0;
+
+        // Returns true while the data is in use, and its contact must not be demoted.
+        // Added in libcontactcache-qt5.so.2
+        virtual bool isActive() const { return true; }
     };
 
     struct CacheItem;
@@ -152,10 +173,36 @@ public:
         virtual void itemUpdated(CacheItem *item) = 0;
         virtual void itemAboutToBeRemoved(CacheItem *item) = 0;
 
+        // Returns true if the listener uses the complete contact, which must not be demoted;
+        // passive listeners that only observe changes should return false.
+        // Added in libcontactcache-qt5.so.2
+        virtual bool isActive() const { return true; }
+
         ItemListener *next;
         void *key;
     };
 
+    // The significant fields of a phone number, parsed once when the number is indexed
+    struct ParsedPhoneNumber
+    {
+        ParsedPhoneNumber()
+            : nationalNumber(0), countryCode(0), leadingZeros(0), regional(false), valid(false)
+        {}
+
+        bool operator==(const ParsedPhoneNumber &other) const
+        {
+            return other.nationalNumber == nationalNumber && other.countryCode == countryCode
+                    && other.leadingZeros == leadingZeros && other.extension == extension;
+        }
+
+        quint64 nationalNumber;
+        QString extension;
+        quint16 countryCode;
+        quint8 leadingZeros;    // Non-zero only for numbers retaining an Italian leading zero
+        bool regional;          // The number has no country code, and was parsed for the default region
+        bool valid;
+    };
+
     struct CachedPhoneNumber
     {
         CachedPhoneNumber()
@@ -165,8 +212,12 @@ public:
             : normalizedNumber(n), iid(i)
         {}
 
+        CachedPhoneNumber(const QString &n, const ParsedPhoneNumber &p, quint32 i)
+            : normalizedNumber(n), parsedNumber(p), iid(i)
+        {}
+
         CachedPhoneNumber(const CachedPhoneNumber &other)
-            : normalizedNumber(other.normalizedNumber), iid(other.iid)
+            : normalizedNumber(other.normalizedNumber), parsedNumber(other.parsedNumber), iid(other.iid)
         {}
 
         bool operator==(const CachedPhoneNumber &other) const
@@ -175,11 +226,64 @@ public:
         }
 
         QString normalizedNumber;
+        ParsedPhoneNumber parsedNumber;
         quint32 iid;
     };
 
+    // An immutable copy of the address indexes and list metadata, published periodically by
+    // the cache.  Unlike the rest of the cache API, it may be used from any thread.
+    class CONTACTCACHE_EXPORT AddressSnapshot
+    {
+    public:
+        struct Contact
+        {
+            Contact()
+                : iid(0), statusFlags(0), favorite(false), presenceState(0)
+            {}
+
+            bool isValid() const { return iid != 0; }
+
+            quint32 iid;
+            QString displayLabel;
+            QString displayLabelGroup;
+            quint64 statusFlags;
+            bool favorite;
+            int presenceState;
+        };
+
+        AddressSnapshot()
+            : m_epoch(0), m_phoneNumbersIndexed(false)
+        {}
+
+        quint64 epoch() const { return m_epoch; }
+        bool phoneNumbersIndexed() const { return m_phoneNumbersIndexed; }
+
+        Contact contact(quint32 iid) const;
+        Contact contactByPhoneNumber(const QString &number) const;
+        Contact contactByEmailAddress(const QString &address) const;
+        Contact contactByOnlineAccount(const QString &localUid, const QString &remoteUid) const;
+
+    private:
+        friend class SeasideCache;
+
+        quint32 matchingPhoneNumber(const QString &number, const QString &normalized) const;
+
+        quint64 m_epoch;
+        bool m_phoneNumbersIndexed;
+        QMultiHash<QString, CachedPhoneNumber> m_phoneNumberIds;
+        QHash<QString, quint32> m_emailAddressIds;
+        QHash<QPair<QString, QString>, quint32> m_onlineAccountIds;
+        QHash<quint32, Contact> m_contacts;
+    };
+
     struct CacheItem
     {
+        enum SortKey {
+            FirstNameSortKey = 0,
+            LastNameSortKey,
+            DisplayLabelSortKey
+        };
+
         CacheItem()
             : itemData(nullptr), iid(0), statusFlags(0), contactState(ContactAbsent),
               listeners(nullptr), filterMatchRole(-1)
@@ -247,6 +351,7 @@ public:
         QString displayLabelGroup;
         QString displayLabel;
         int filterMatchRole;
+        QList<QCollatorSortKey> sortKeys; // indexed by SortKey
     };
 
     struct ContactLinkRequest
@@ -276,9 +381,16 @@ public:
         virtual void sourceItemsInserted(int begin, int end) = 0;
 
         virtual void sourceDataChanged(int begin, int end) = 0;
+        // The changes are a combination of ItemDataChange values
+        virtual void sourceDataChanged(int begin, int end, quint32 changes) { Q_UNUSED(changes) sourceDataChanged(begin, end); }
 
         virtual void sourceItemsChanged() = 0;
 
+        // The source list has been reordered in place; models holding persistent
+        // indexes must map them to the new rows of their contacts
+        virtual void sourceAboutToChangeLayout() { emit layoutAboutToBeChanged(); }
+        virtual void sourceLayoutChanged() { emit layoutChanged(); }
+
         virtual void makePopulated() = 0;
         virtual void updateDisplayLabelOrder() = 0;
         virtual void updateSortProperty() = 0;
@@ -294,6 +406,10 @@ public:
         virtual ~ResolveListener() {}
 
         virtual void addressResolved(const QString &first, const QString &second, CacheItem *item) = 0;
+
+        // Invoked after each batch of addresses fetched for resolveAddresses() has been reported.
+        // Added in libcontactcache-qt5.so.2
+        virtual void addressBatchResolved() {}
     };
 
     struct ChangeListener
@@ -352,6 +468,8 @@ public:
     static QStringList allDisplayLabelGroups();
     static QHash<QString, QSet<quint32> > displayLabelGroupMembers();
 
+    static std::shared_ptr<const AddressSnapshot> addressSnapshot();
+
     static CacheItem *itemByPhoneNumber(const QString &number, bool requireComplete = true);
     static CacheItem *itemByEmailAddress(const QString &address, bool requireComplete = true);
     static CacheItem *itemByOnlineAccount(const QString &localUid, const QString &remoteUid,
@@ -363,6 +481,9 @@ public:
                                           bool requireComplete = true);
     static CacheItem *resolveOnlineAccount(ResolveListener *listener, const QString &localUid,
                                            const QString &remoteUid, bool requireComplete = true);
+    static QList<CacheItem *> resolveAddresses(ResolveListener *listener,
+                                               const QList<QPair<QString, QString> > &addresses,
+                                               bool requireComplete = true);
 
     static bool saveContact(const QContact &contact);
     static bool saveContacts(const QList<QContact> &contacts);
@@ -381,7 +502,14 @@ public:
     static void initialize(FetchDataType requiredTypes = FetchNone,
                            FetchDataType extraTypes = FetchNone);
     static const QList<quint32> *contacts(FilterType filterType);
+    static const SeasideContactIdList *contactIdList(FilterType filterType);
+    static void setBatchTimeBudget(int milliseconds);
+    static int batchTimeBudget();
+    static void setCompleteContactBudget(qint64 bytes);
+    static qint64 completeContactBudget();
+    static QVariantMap cacheStatistics();
     static bool isPopulated(FilterType filterType);
+    static bool isDisplayOff();
 
     static QString getPrimaryName(const QContact &contact);
     static QString getSecondaryName(const QContact &contact);
@@ -419,6 +547,7 @@ public:
 
 signals:
     void populatedChanged();
+    void displayStateChanged();
 
 protected:
     void timerEvent(QTimerEvent *event);
@@ -427,6 +556,7 @@ protected:
 
 private slots:
     void contactsAvailable();
+    void contactsDecoded();
     void contactIdsAvailable();
     void relationshipsAvailable();
     void requestStateChanged(QContactAbstractRequest::State state);
@@ -449,6 +579,36 @@ private:
         Populated
     };
 
+    enum SnapshotState {
+        SnapshotCurrent,
+        SnapshotRefreshFavorites,
+        SnapshotRefreshAll,
+        SnapshotSaveRequired
+    };
+
+    // A fetched contact, with the values derived from it precomputed by the decode stage
+    struct DecodedContact
+    {
+        QContact contact;
+        DisplayLabelOrder displayLabelOrder;
+        QString firstName;
+        QString lastName;
+        QString labelDetail;
+        QString displayLabel;
+        QList<QCollatorSortKey> sortKeys;
+        QStringList phoneNumbers;
+        QStringList normalizedPhoneNumbers;
+        QList<ParsedPhoneNumber> parsedPhoneNumbers;
+        QList<QList<QPair<QString, QString> > > phoneNumberAddresses;
+    };
+
+    struct DecodeJob
+    {
+        QFutureWatcher<QList<DecodedContact> > *watcher;
+        FilterType appendFilter;
+        QSet<QContactDetail::DetailType> detailTypes;
+    };
+
     SeasideCache();
     ~SeasideCache();
 
@@ -457,29 +617,53 @@ private:
     void keepPopulated(quint32 requiredTypes, quint32 extraTypes);
 
     void requestUpdate();
-    void appendContacts(const QList<QContact> &contacts, FilterType filterType, bool partialFetch,
+    void appendContacts(const QList<DecodedContact> &contacts, FilterType filterType, bool partialFetch,
                         const QSet<QContactDetail::DetailType> &queryDetailTypes);
     void fetchContacts();
     void updateContacts(const QList<QContactId> &contactIds, QList<QContactId> *updateList);
     void applyPendingContactUpdates();
-    void applyContactUpdates(const QList<QContact> &contacts,
+    void applyContactUpdates(const QList<DecodedContact> &contacts,
                              const QSet<QContactDetail::DetailType> &queryDetailTypes);
     void updateSectionBucketIndexCaches();
 
+    static QList<DecodedContact> decodeContacts(const QList<QContact> &contacts, DisplayLabelOrder order,
+                                                const QCollator &collator);
+    void scheduleDecode(const QList<QContact> &contacts, FilterType appendFilter,
+                        const QSet<QContactDetail::DetailType> &queryDetailTypes);
+    void queueContacts(const QList<DecodedContact> &contacts, FilterType appendFilter,
+                       const QSet<QContactDetail::DetailType> &queryDetailTypes);
+    bool decodePending(FilterType appendFilter) const;
+
     void resolveUnknownAddresses(const QString &first, const QString &second, CacheItem *item);
     bool updateContactIndexing(const QContact &oldContact, const QContact &contact, quint32 iid,
-                               const QSet<QContactDetail::DetailType> &queryDetailTypes, CacheItem *item);
-    void updateCache(CacheItem *item, const QContact &contact, bool partialFetch, bool initialInsert);
+                               const QSet<QContactDetail::DetailType> &queryDetailTypes, CacheItem *item,
+                               const DecodedContact *decoded = nullptr);
+    void updateCache(CacheItem *item, const QContact &contact, bool partialFetch, bool initialInsert,
+                     const DecodedContact *decoded = nullptr);
+    void updateMetadata(CacheItem *item, const DecodedContact *decoded = nullptr);
+    bool resortContacts();
+    void reorderContacts();
     void reportItemUpdated(CacheItem *item);
+    void invalidateAddressSnapshot();
+    void updateSnapshotContact(const CacheItem *item);
+    void publishAddressSnapshot();
+    void recordCompleteContact(CacheItem *item);
+    void touchCompleteContact(quint32 iid);
+    void forgetCompleteContact(quint32 iid);
+    void demoteCompleteContacts();
 
     void removeRange(FilterType filter, int index, int count);
     int insertRange(FilterType filter, int index, int count, const QList<quint32> &queryIds, int queryIndex);
 
     void contactDataChanged(quint32 iid);
     void contactDataChanged(quint32 iid, FilterType filter);
+    void contactDataChanged(const QList<quint32> &iids, FilterType filter, quint32 changes = AllDataChanged);
     void removeContactData(quint32 iid, FilterType filter);
     void makePopulated(FilterType filter);
 
+    bool loadSnapshot();
+    void saveSnapshot();
+
     void addToContactDisplayLabelGroup(quint32 iid, const QString &group, QSet<QString> *modifiedGroups = 0);
     void removeFromContactDisplayLabelGroup(quint32 iid, const QString &group, QSet<QString> *modifiedGroups = 0);
     void notifyDisplayLabelGroupsChanged(const QSet<QString> &groups);
@@ -488,10 +672,18 @@ private:
     void completeContactAggregation(const QContactId &contact1Id, const QContactId &contact2Id);
 
     void resolveAddress(ResolveListener *listener, const QString &first, const QString &second, bool requireComplete);
+    bool isKnownUnknownAddress(const QString &first, const QString &second) const;
+    QContactFetchRequest *resolveRequest(const QContactFilter &filter, bool requireComplete);
+    CacheItem *resolvedItem(const QString &first, const QString &second);
+
+    static QContactFilter resolveFilter(const QString &first, const QString &second);
+    static QString unknownAddressCompare(const QString &first, const QString &second);
 
     CacheItem *itemMatchingPhoneNumber(const QString &number, const QString &normalized, bool requireComplete);
 
     int contactIndex(quint32 iid, FilterType filter);
+    bool placeContact(quint32 iid, FilterType filter, bool member);
+    void applyDeltaSync();
 
     QContactFilter filterForMergeCandidates(const QContact &contact) const;
     QContactFilter aggregateFilter() const;
@@ -501,10 +693,11 @@ private:
 
     static QContactRelationship makeRelationship(const QString &type, const QContactId &id1, const QContactId &id2);
 
-    QList<quint32> m_contacts[FilterTypesCount];
+    SeasideContactIdList m_contacts[FilterTypesCount];
 
     QBasicTimer m_expiryTimer;
     QBasicTimer m_fetchTimer;
+    QBasicTimer m_addressSnapshotTimer;
     QHash<quint32, CacheItem> m_people;
     QMultiHash<QString, CachedPhoneNumber> m_phoneNumberIds;
     QHash<QString, quint32> m_emailAddressIds;
@@ -512,12 +705,14 @@ private:
     QMap<QContactCollectionId, QHash<QContactId, QContact> > m_contactsToSave;
     QHash<QString, QSet<quint32> > m_contactDisplayLabelGroups;
     QList<QContact> m_contactsToCreate;
-    QHash<FilterType, QPair<QSet<QContactDetail::DetailType>, QList<QContact> > > m_contactsToAppend;
-    QList<QPair<QSet<QContactDetail::DetailType>, QList<QContact> > > m_contactsToUpdate;
+    QList<DecodeJob> m_decodeJobs;
+    QHash<FilterType, QPair<QSet<QContactDetail::DetailType>, QList<DecodedContact> > > m_contactsToAppend;
+    QList<QPair<QSet<QContactDetail::DetailType>, QList<DecodedContact> > > m_contactsToUpdate;
     QMap<QContactCollectionId, QList<QContactId> > m_contactsToRemove;
     QList<QContactId> m_localContactsToRemove;
     QList<QContactId> m_changedContacts;
     QList<QContactId> m_presenceChangedContacts;
+    QList<QPair<QSet<QContactDetail::DetailType>, QList<QContactId> > > m_typedChangedContacts;
     QSet<QContactId> m_aggregatedContacts;
     QList<QContactId> m_contactsToFetchConstituents;
     QList<QContactId> m_contactsToFetchCandidates;
@@ -540,6 +735,7 @@ private:
     QContactRelationshipSaveRequest m_relationshipSaveRequest;
     QContactRelationshipRemoveRequest m_relationshipRemoveRequest;
     QList<QContactSortOrder> m_sortOrder;
+    QCollator m_sortCollator;
     QList<QContactSortOrder> m_onlineSortOrder;
     FilterType m_syncFilter;
     int m_populated;
@@ -558,10 +754,23 @@ private:
     quint32 m_dataTypesFetched;
     bool m_updatesPending;
     bool m_refreshRequired;
-    bool m_contactsUpdated;
     bool m_displayOff;
+    SnapshotState m_snapshotState;
+    int m_appendBatchSize;
+    int m_updateBatchSize;
+    quint64 m_addressSnapshotEpoch;
+    QHash<quint32, AddressSnapshot::Contact> m_snapshotContacts;
+    QMap<quint64, quint32> m_completeContactOrder;
+    QHash<quint32, QPair<quint64, int> > m_completeContacts;
+    qint64 m_completeContactsSize;
+    quint64 m_completeContactTick;
+    int m_demotedContactCount;
+    bool m_completeContactsStalled;
     QSet<QContactId> m_constituentIds;
     QSet<QContactId> m_candidateIds;
+    QSet<quint32> m_deltaSyncIds;
+    QSet<quint32> m_deltaRemovedIds;
+    QSet<quint32> m_deltaFetchIds;
 
     struct ResolveData {
         QString first;
@@ -570,7 +779,10 @@ private:
         bool requireComplete;
         ResolveListener *listener;
     };
+    void resolveAddressBatch(const QList<ResolveData> &batch);
+
     QHash<QContactFetchRequest *, ResolveData> m_resolveAddresses;
+    QHash<QContactFetchRequest *, QList<ResolveData> > m_resolveAddressBatches;
     QSet<ResolveData> m_pendingResolve; // these have active requests already
     QList<ResolveData> m_unknownResolveAddresses;
     QList<ResolveData> m_unknownAddresses;
@@ -581,6 +793,8 @@ private:
 
     static SeasideCache *instancePtr;
     static int contactDisplayLabelGroupCount;
+    static int batchTimeBudgetMs;
+    static qint64 completeContactBudgetBytes;
     static QStringList allContactDisplayLabelGroups;
     static QTranslator *engEnTranslator;
     static QTranslator *translator;
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2013 - 2020 Jolla Ltd.
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef SEASIDECONTACTIDLIST_H
+#define SEASIDECONTACTIDLIST_H
+
+#include <QList>
+#include <QMultiHash>
+#include <QVector>
+
+// An ordered list of contact ids, supporting positional insertion and removal and
+// reverse lookup of an id's position without linear scanning.
+//
+// The ids are stored in bounded chunks.  A Fenwick tree over the chunk sizes locates
+// the chunk containing any position, and the offset of any chunk, in O(log n) time;
+// a reverse index maps each id to the chunk containing it.  The structure only needs
+// to be rebuilt when chunks are split or merged.
+
+class SeasideContactIdList
+{
+public:
+    typedef quint32 value_type;
+    typedef const quint32 &const_reference;
+
+    enum { ChunkSize = 256 };
+
+    SeasideContactIdList()
+        : m_count(0)
+        , m_listViewEnabled(false)
+    {
+    }
+
+    explicit SeasideContactIdList(const QList<quint32> &ids)
+        : m_count(0)
+        , m_listViewEnabled(false)
+    {
+        for (quint32 iid : ids)
+            append(iid);
+    }
+
+    SeasideContactIdList &operator=(const QList<quint32> &ids)
+    {
+        clear();
+        for (quint32 iid : ids)
+            append(iid);
+        return *this;
+    }
+
+    int count() const { return m_count; }
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    const quint32 &at(int index) const
+    {
+        Q_ASSERT(index >= 0 && index < m_count);
+
+        int offset = index;
+        const int position = findChunk(&offset);
+        return m_chunks.at(m_order.at(position)).ids.at(offset);
+    }
+
+    bool contains(quint32 iid) const
+    {
+        return m_chunkIds.contains(iid);
+    }
+
+    int indexOf(quint32 iid) const
+    {
+        int rv = -1;
+
+        // An id may be present more than once while a list is being synchronized
+        QMultiHash<quint32, int>::const_iterator it = m_chunkIds.constFind(iid), end = m_chunkIds.constEnd();
+        for ( ; it != end && it.key() == iid; ++it) {
+            const Chunk &chunk(m_chunks.at(it.value()));
+            const int index = prefixCount(chunk.position) + chunk.ids.indexOf(iid);
+            if (rv == -1 || index < rv)
+                rv = index;
+        }
+
+        return rv;
+    }
+
+    void append(quint32 iid)
+    {
+        insert(m_count, iid);
+    }
+
+    void insert(int index, quint32 iid)
+    {
+        Q_ASSERT(index >= 0 && index <= m_count);
+
+        int position;
+        int offset = index;
+        if (index == m_count) {
+            // Fill chunks completely when appending, rather than splitting them
+            position = m_order.count() - 1;
+            if (position < 0 || m_chunks.at(m_order.at(position)).ids.count() >= ChunkSize) {
+                position = m_order.count();
+                m_order.append(allocateChunk());
+                rebuildTree();
+            }
+            offset = m_chunks.at(m_order.at(position)).ids.count();
+        } else {
+            position = findChunk(&offset);
+        }
+
+        const int id = m_order.at(position);
+        QVector<quint32> &ids(m_chunks[id].ids);
+        ids.insert(offset, iid);
+        m_chunkIds.insert(iid, id);
+        ++m_count;
+
+        if (m_listViewEnabled)
+            m_listView.insert(index, iid);
+
+        if (ids.count() > 2 * ChunkSize) {
+            splitChunk(position);
+        } else {
+            addToTree(position, 1);
+        }
+    }
+
+    void removeAt(int index)
+    {
+        remove(index, 1);
+    }
+
+    void remove(int index, int count)
+    {
+        Q_ASSERT(index >= 0 && count >= 0 && index + count <= m_count);
+        if (count <= 0)
+            return;
+
+        if (m_listViewEnabled)
+            m_listView.erase(m_listView.begin() + index, m_listView.begin() + index + count);
+
+        int offset = index;
+        int position = findChunk(&offset);
+        const int firstPosition = position;
+        bool restructured = false;
+
+        while (count > 0) {
+            const int id = m_order.at(position);
+            QVector<quint32> &ids(m_chunks[id].ids);
+            const int n = qMin(count, ids.count() - offset);
+
+            for (int i = offset; i < offset + n; ++i) {
+                QMultiHash<quint32, int>::iterator it = m_chunkIds.find(ids.at(i), id);
+                Q_ASSERT(it != m_chunkIds.end());
+                m_chunkIds.erase(it);
+            }
+            ids.remove(offset, n);
+            count -= n;
+            m_count -= n;
+
+            if (ids.isEmpty()) {
+                releaseChunk(position);
+                restructured = true;
+            } else {
+                if (!restructured)
+                    addToTree(position, -n);
+                ++position;
+            }
+            offset = 0;
+        }
+
+        // Avoid accumulating many small chunks where ranges have been removed
+        if (firstPosition > 0 && firstPosition < m_order.count())
+            restructured |= mergeChunks(firstPosition - 1);
+        if (firstPosition < m_order.count() - 1)
+            restructured |= mergeChunks(firstPosition);
+
+        if (restructured)
+            rebuildTree();
+    }
+
+    void clear()
+    {
+        m_chunks.clear();
+        m_freeChunks.clear();
+        m_order.clear();
+        m_tree.clear();
+        m_chunkIds.clear();
+        m_count = 0;
+        m_listView.clear();
+    }
+
+    QList<quint32> toList() const
+    {
+        QList<quint32> rv;
+        rv.reserve(m_count);
+        for (int id : m_order) {
+            for (quint32 iid : m_chunks.at(id).ids)
+                rv.append(iid);
+        }
+        return rv;
+    }
+
+    // A list copy of the ids, for interfaces that require a QList.  Once requested, the
+    // copy is maintained with each modification, so the pointer remains current.
+    const QList<quint32> *listView() const
+    {
+        if (!m_listViewEnabled) {
+            m_listView = toList();
+            m_listViewEnabled = true;
+        }
+        return &m_listView;
+    }
+
+private:
+    struct Chunk
+    {
+        Chunk() : position(-1) {}
+
+        QVector<quint32> ids;
+        int position;
+    };
+
+    int allocateChunk()
+    {
+        if (!m_freeChunks.isEmpty())
+            return m_freeChunks.takeLast();
+
+        m_chunks.append(Chunk());
+        return m_chunks.count() - 1;
+    }
+
+    void releaseChunk(int position)
+    {
+        const int id = m_order.takeAt(position);
+        m_chunks[id] = Chunk();
+        m_freeChunks.append(id);
+    }
+
+    void moveIds(const QVector<quint32> &ids, int from, int to)
+    {
+        for (quint32 iid : ids) {
+            QMultiHash<quint32, int>::iterator it = m_chunkIds.find(iid, from);
+            Q_ASSERT(it != m_chunkIds.end());
+            it.value() = to;
+        }
+    }
+
+    void splitChunk(int position)
+    {
+        const int id = m_order.at(position);
+        const int tailId = allocateChunk();
+
+        QVector<quint32> &ids(m_chunks[id].ids);
+        const int half = ids.count() / 2;
+        m_chunks[tailId].ids = ids.mid(half);
+        ids.resize(half);
+        moveIds(m_chunks.at(tailId).ids, id, tailId);
+
+        m_order.insert(position + 1, tailId);
+        rebuildTree();
+    }
+
+    bool mergeChunks(int position)
+    {
+        const int id = m_order.at(position);
+        const int nextId = m_order.at(position + 1);
+        if (m_chunks.at(id).ids.count() + m_chunks.at(nextId).ids.count() > ChunkSize)
+            return false;
+
+        moveIds(m_chunks.at(nextId).ids, nextId, id);
+        m_chunks[id].ids += m_chunks.at(nextId).ids;
+        releaseChunk(position + 1);
+        return true;
+    }
+
+    void rebuildTree()
+    {
+        m_tree.fill(0, m_order.count() + 1);
+        for (int i = 0; i < m_order.count(); ++i) {
+            Chunk &chunk(m_chunks[m_order.at(i)]);
+            chunk.position = i;
+
+            const int node = i + 1;
+            m_tree[node] += chunk.ids.count();
+            const int parent = node + (node & -node);
+            if (parent < m_tree.count())
+                m_tree[parent] += m_tree.at(node);
+        }
+    }
+
+    void addToTree(int position, int delta)
+    {
+        for (int node = position + 1; node < m_tree.count(); node += (node & -node))
+            m_tree[node] += delta;
+    }
+
+    // Returns the number of ids stored in the chunks preceding the chunk at position
+    int prefixCount(int position) const
+    {
+        int rv = 0;
+        for (int node = position; node > 0; node -= (node & -node))
+            rv += m_tree.at(node);
+        return rv;
+    }
+
+    // Returns the position of the chunk containing the id at *offset, and
+    // updates *offset to be the offset of that id within the chunk
+    int findChunk(int *offset) const
+    {
+        const int chunkCount = m_tree.count() - 1;
+
+        int step = 1;
+        while (step * 2 <= chunkCount)
+            step *= 2;
+
+        int position = 0;
+        int remaining = *offset;
+        for ( ; step > 0; step /= 2) {
+            const int node = position + step;
+            if (node <= chunkCount && m_tree.at(node) <= remaining) {
+                position = node;
+                remaining -= m_tree.at(node);
+            }
+        }
+
+        *offset = remaining;
+        return position;
+    }
+
+    QVector<Chunk> m_chunks;
+    QVector<int> m_freeChunks;
+    QVector<int> m_order;
+    QVector<int> m_tree;
+    QMultiHash<quint32, int> m_chunkIds;
+    int m_count;
+    mutable QList<quint32> m_listView;
+    mutable bool m_listViewEnabled;
+};
+
+#endif
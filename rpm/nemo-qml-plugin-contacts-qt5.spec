@@ -8,6 +8,7 @@ URL:        https://github.com/sailfishos/nemo-qml-plugin-contacts
 Source0:    %{name}-%{version}.tar.bz2
 Requires:   qtcontacts-sqlite-qt5 >= 0.1.37
 BuildRequires:  pkgconfig(Qt5Core)
+BuildRequires:  pkgconfig(Qt5Concurrent)
 BuildRequires:  pkgconfig(Qt5Qml)
 BuildRequires:  pkgconfig(Qt5Contacts)
 BuildRequires:  pkgconfig(Qt5Versit)
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#ifndef SEASIDECHARACTERFOLDING_H
+#define SEASIDECHARACTERFOLDING_H
+
+#include <QtGlobal>
+
+// The canonical decompositions (NFD) of the precomposed Latin letters, generated from the
+// Unicode character database. Each entry holds the base character followed by up to two
+// combining marks, padded with zeros; characters without a decomposition map to themselves.
+
+// U+00C0 to U+024F: Latin-1 Supplement letters, Latin Extended-A and Latin Extended-B
+constexpr ushort latinFoldingsBegin = 0x00c0;
+constexpr ushort latinFoldings[][3] = {
+    { 0x0041, 0x0300, 0x0000 }, { 0x0041, 0x0301, 0x0000 }, { 0x0041, 0x0302, 0x0000 }, { 0x0041, 0x0303, 0x0000 }, // U+00C0
+    { 0x0041, 0x0308, 0x0000 }, { 0x0041, 0x030a, 0x0000 }, { 0x00c6, 0x0000, 0x0000 }, { 0x0043, 0x0327, 0x0000 }, // U+00C4
+    { 0x0045, 0x0300, 0x0000 }, { 0x0045, 0x0301, 0x0000 }, { 0x0045, 0x0302, 0x0000 }, { 0x0045, 0x0308, 0x0000 }, // U+00C8
+    { 0x0049, 0x0300, 0x0000 }, { 0x0049, 0x0301, 0x0000 }, { 0x0049, 0x0302, 0x0000 }, { 0x0049, 0x0308, 0x0000 }, // U+00CC
+    { 0x00d0, 0x0000, 0x0000 }, { 0x004e, 0x0303, 0x0000 }, { 0x004f, 0x0300, 0x0000 }, { 0x004f, 0x0301, 0x0000 }, // U+00D0
+    { 0x004f, 0x0302, 0x0000 }, { 0x004f, 0x0303, 0x0000 }, { 0x004f, 0x0308, 0x0000 }, { 0x00d7, 0x0000, 0x0000 }, // U+00D4
+    { 0x00d8, 0x0000, 0x0000 }, { 0x0055, 0x0300, 0x0000 }, { 0x0055, 0x0301, 0x0000 }, { 0x0055, 0x0302, 0x0000 }, // U+00D8
+    { 0x0055, 0x0308, 0x0000 }, { 0x0059, 0x0301, 0x0000 }, { 0x00de, 0x0000, 0x0000 }, { 0x00df, 0x0000, 0x0000 }, // U+00DC
+    { 0x0061, 0x0300, 0x0000 }, { 0x0061, 0x0301, 0x0000 }, { 0x0061, 0x0302, 0x0000 }, { 0x0061, 0x0303, 0x0000 }, // U+00E0
+    { 0x0061, 0x0308, 0x0000 }, { 0x0061, 0x030a, 0x0000 }, { 0x00e6, 0x0000, 0x0000 }, { 0x0063, 0x0327, 0x0000 }, // U+00E4
+    { 0x0065, 0x0300, 0x0000 }, { 0x0065, 0x0301, 0x0000 }, { 0x0065, 0x0302, 0x0000 }, { 0x0065, 0x0308, 0x0000 }, // U+00E8
+    { 0x0069, 0x0300, 0x0000 }, { 0x0069, 0x0301, 0x0000 }, { 0x0069, 0x0302, 0x0000 }, { 0x0069, 0x0308, 0x0000 }, // U+00EC
+    { 0x00f0, 0x0000, 0x0000 }, { 0x006e, 0x0303, 0x0000 }, { 0x006f, 0x0300, 0x0000 }, { 0x006f, 0x0301, 0x0000 }, // U+00F0
+    { 0x006f, 0x0302, 0x0000 }, { 0x006f, 0x0303, 0x0000 }, { 0x006f, 0x0308, 0x0000 }, { 0x00f7, 0x0000, 0x0000 }, // U+00F4
+    { 0x00f8, 0x0000, 0x0000 }, { 0x0075, 0x0300, 0x0000 }, { 0x0075, 0x0301, 0x0000 }, { 0x0075, 0x0302, 0x0000 }, // U+00F8
+    { 0x0075, 0x0308, 0x0000 }, { 0x0079, 0x0301, 0x0000 }, { 0x00fe, 0x0000, 0x0000 }, { 0x0079, 0x0308, 0x0000 }, // U+00FC
+    { 0x0041, 0x0304, 0x0000 }, { 0x0061, 0x0304, 0x0000 }, { 0x0041, 0x0306, 0x0000 }, { 0x0061, 0x0306, 0x0000 }, // U+0100
+    { 0x0041, 0x0328, 0x0000 }, { 0x0061, 0x0328, 0x0000 }, { 0x0043, 0x0301, 0x0000 }, { 0x0063, 0x0301, 0x0000 }, // U+0104
+    { 0x0043, 0x0302, 0x0000 }, { 0x0063, 0x0302, 0x0000 }, { 0x0043, 0x0307, 0x0000 }, { 0x0063, 0x0307, 0x0000 }, // U+0108
+    { 0x0043, 0x030c, 0x0000 }, { 0x0063, 0x030c, 0x0000 }, { 0x0044, 0x030c, 0x0000 }, { 0x0064, 0x030c, 0x0000 }, // U+010C
+    { 0x0110, 0x0000, 0x0000 }, { 0x0111, 0x0000, 0x0000 }, { 0x0045, 0x0304, 0x0000 }, { 0x0065, 0x0304, 0x0000 }, // U+0110
+    { 0x0045, 0x0306, 0x0000 }, { 0x0065, 0x0306, 0x0000 }, { 0x0045, 0x0307, 0x0000 }, { 0x0065, 0x0307, 0x0000 }, // U+0114
+    { 0x0045, 0x0328, 0x0000 }, { 0x0065, 0x0328, 0x0000 }, { 0x0045, 0x030c, 0x0000 }, { 0x0065, 0x030c, 0x0000 }, // U+0118
+    { 0x0047, 0x0302, 0x0000 }, { 0x0067, 0x0302, 0x0000 }, { 0x0047, 0x0306, 0x0000 }, { 0x0067, 0x0306, 0x0000 }, // U+011C
+    { 0x0047, 0x0307, 0x0000 }, { 0x0067, 0x0307, 0x0000 }, { 0x0047, 0x0327, 0x0000 }, { 0x0067, 0x0327, 0x0000 }, // U+0120
+    { 0x0048, 0x0302, 0x0000 }, { 0x0068, 0x0302, 0x0000 }, { 0x0126, 0x0000, 0x0000 }, { 0x0127, 0x0000, 0x0000 }, // U+0124
+    { 0x0049, 0x0303, 0x0000 }, { 0x0069, 0x0303, 0x0000 }, { 0x0049, 0x0304, 0x0000 }, { 0x0069, 0x0304, 0x0000 }, // U+0128
+    { 0x0049, 0x0306, 0x0000 }, { 0x0069, 0x0306, 0x0000 }, { 0x0049, 0x0328, 0x0000 }, { 0x0069, 0x0328, 0x0000 }, // U+012C
+    { 0x0049, 0x0307, 0x0000 }, { 0x0131, 0x0000, 0x0000 }, { 0x0132, 0x0000, 0x0000 }, { 0x0133, 0x0000, 0x0000 }, // U+0130
+    { 0x004a, 0x0302, 0x0000 }, { 0x006a, 0x0302, 0x0000 }, { 0x004b, 0x0327, 0x0000 }, { 0x006b, 0x0327, 0x0000 }, // U+0134
+    { 0x0138, 0x0000, 0x0000 }, { 0x004c, 0x0301, 0x0000 }, { 0x006c, 0x0301, 0x0000 }, { 0x004c, 0x0327, 0x0000 }, // U+0138
+    { 0x006c, 0x0327, 0x0000 }, { 0x004c, 0x030c, 0x0000 }, { 0x006c, 0x030c, 0x0000 }, { 0x013f, 0x0000, 0x0000 }, // U+013C
+    { 0x0140, 0x0000, 0x0000 }, { 0x0141, 0x0000, 0x0000 }, { 0x0142, 0x0000, 0x0000 }, { 0x004e, 0x0301, 0x0000 }, // U+0140
+    { 0x006e, 0x0301, 0x0000 }, { 0x004e, 0x0327, 0x0000 }, { 0x006e, 0x0327, 0x0000 }, { 0x004e, 0x030c, 0x0000 }, // U+0144
+    { 0x006e, 0x030c, 0x0000 }, { 0x0149, 0x0000, 0x0000 }, { 0x014a, 0x0000, 0x0000 }, { 0x014b, 0x0000, 0x0000 }, // U+0148
+    { 0x004f, 0x0304, 0x0000 }, { 0x006f, 0x0304, 0x0000 }, { 0x004f, 0x0306, 0x0000 }, { 0x006f, 0x0306, 0x0000 }, // U+014C
+    { 0x004f, 0x030b, 0x0000 }, { 0x006f, 0x030b, 0x0000 }, { 0x0152, 0x0000, 0x0000 }, { 0x0153, 0x0000, 0x0000 }, // U+0150
+    { 0x0052, 0x0301, 0x0000 }, { 0x0072, 0x0301, 0x0000 }, { 0x0052, 0x0327, 0x0000 }, { 0x0072, 0x0327, 0x0000 }, // U+0154
+    { 0x0052, 0x030c, 0x0000 }, { 0x0072, 0x030c, 0x0000 }, { 0x0053, 0x0301, 0x0000 }, { 0x0073, 0x0301, 0x0000 }, // U+0158
+    { 0x0053, 0x0302, 0x0000 }, { 0x0073, 0x0302, 0x0000 }, { 0x0053, 0x0327, 0x0000 }, { 0x0073, 0x0327, 0x0000 }, // U+015C
+    { 0x0053, 0x030c, 0x0000 }, { 0x0073, 0x030c, 0x0000 }, { 0x0054, 0x0327, 0x0000 }, { 0x0074, 0x0327, 0x0000 }, // U+0160
+    { 0x0054, 0x030c, 0x0000 }, { 0x0074, 0x030c, 0x0000 }, { 0x0166, 0x0000, 0x0000 }, { 0x0167, 0x0000, 0x0000 }, // U+0164
+    { 0x0055, 0x0303, 0x0000 }, { 0x0075, 0x0303, 0x0000 }, { 0x0055, 0x0304, 0x0000 }, { 0x0075, 0x0304, 0x0000 }, // U+0168
+    { 0x0055, 0x0306, 0x0000 }, { 0x0075, 0x0306, 0x0000 }, { 0x0055, 0x030a, 0x0000 }, { 0x0075, 0x030a, 0x0000 }, // U+016C
+    { 0x0055, 0x030b, 0x0000 }, { 0x0075, 0x030b, 0x0000 }, { 0x0055, 0x0328, 0x0000 }, { 0x0075, 0x0328, 0x0000 }, // U+0170
+    { 0x0057, 0x0302, 0x0000 }, { 0x0077, 0x0302, 0x0000 }, { 0x0059, 0x0302, 0x0000 }, { 0x0079, 0x0302, 0x0000 }, // U+0174
+    { 0x0059, 0x0308, 0x0000 }, { 0x005a, 0x0301, 0x0000 }, { 0x007a, 0x0301, 0x0000 }, { 0x005a, 0x0307, 0x0000 }, // U+0178
+    { 0x007a, 0x0307, 0x0000 }, { 0x005a, 0x030c, 0x0000 }, { 0x007a, 0x030c, 0x0000 }, { 0x017f, 0x0000, 0x0000 }, // U+017C
+    { 0x0180, 0x0000, 0x0000 }, { 0x0181, 0x0000, 0x0000 }, { 0x0182, 0x0000, 0x0000 }, { 0x0183, 0x0000, 0x0000 }, // U+0180
+    { 0x0184, 0x0000, 0x0000 }, { 0x0185, 0x0000, 0x0000 }, { 0x0186, 0x0000, 0x0000 }, { 0x0187, 0x0000, 0x0000 }, // U+0184
+    { 0x0188, 0x0000, 0x0000 }, { 0x0189, 0x0000, 0x0000 }, { 0x018a, 0x0000, 0x0000 }, { 0x018b, 0x0000, 0x0000 }, // U+0188
+    { 0x018c, 0x0000, 0x0000 }, { 0x018d, 0x0000, 0x0000 }, { 0x018e, 0x0000, 0x0000 }, { 0x018f, 0x0000, 0x0000 }, // U+018C
+    { 0x0190, 0x0000, 0x0000 }, { 0x0191, 0x0000, 0x0000 }, { 0x0192, 0x0000, 0x0000 }, { 0x0193, 0x0000, 0x0000 }, // U+0190
+    { 0x0194, 0x0000, 0x0000 }, { 0x0195, 0x0000, 0x0000 }, { 0x0196, 0x0000, 0x0000 }, { 0x0197, 0x0000, 0x0000 }, // U+0194
+    { 0x0198, 0x0000, 0x0000 }, { 0x0199, 0x0000, 0x0000 }, { 0x019a, 0x0000, 0x0000 }, { 0x019b, 0x0000, 0x0000 }, // U+0198
+    { 0x019c, 0x0000, 0x0000 }, { 0x019d, 0x0000, 0x0000 }, { 0x019e, 0x0000, 0x0000 }, { 0x019f, 0x0000, 0x0000 }, // U+019C
+    { 0x004f, 0x031b, 0x0000 }, { 0x006f, 0x031b, 0x0000 }, { 0x01a2, 0x0000, 0x0000 }, { 0x01a3, 0x0000, 0x0000 }, // U+01A0
+    { 0x01a4, 0x0000, 0x0000 }, { 0x01a5, 0x0000, 0x0000 }, { 0x01a6, 0x0000, 0x0000 }, { 0x01a7, 0x0000, 0x0000 }, // U+01A4
+    { 0x01a8, 0x0000, 0x0000 }, { 0x01a9, 0x0000, 0x0000 }, { 0x01aa, 0x0000, 0x0000 }, { 0x01ab, 0x0000, 0x0000 }, // U+01A8
+    { 0x01ac, 0x0000, 0x0000 }, { 0x01ad, 0x0000, 0x0000 }, { 0x01ae, 0x0000, 0x0000 }, { 0x0055, 0x031b, 0x0000 }, // U+01AC
+    { 0x0075, 0x031b, 0x0000 }, { 0x01b1, 0x0000, 0x0000 }, { 0x01b2, 0x0000, 0x0000 }, { 0x01b3, 0x0000, 0x0000 }, // U+01B0
+    { 0x01b4, 0x0000, 0x0000 }, { 0x01b5, 0x0000, 0x0000 }, { 0x01b6, 0x0000, 0x0000 }, { 0x01b7, 0x0000, 0x0000 }, // U+01B4
+    { 0x01b8, 0x0000, 0x0000 }, { 0x01b9, 0x0000, 0x0000 }, { 0x01ba, 0x0000, 0x0000 }, { 0x01bb, 0x0000, 0x0000 }, // U+01B8
+    { 0x01bc, 0x0000, 0x0000 }, { 0x01bd, 0x0000, 0x0000 }, { 0x01be, 0x0000, 0x0000 }, { 0x01bf, 0x0000, 0x0000 }, // U+01BC
+    { 0x01c0, 0x0000, 0x0000 }, { 0x01c1, 0x0000, 0x0000 }, { 0x01c2, 0x0000, 0x0000 }, { 0x01c3, 0x0000, 0x0000 }, // U+01C0
+    { 0x01c4, 0x0000, 0x0000 }, { 0x01c5, 0x0000, 0x0000 }, { 0x01c6, 0x0000, 0x0000 }, { 0x01c7, 0x0000, 0x0000 }, // U+01C4
+    { 0x01c8, 0x0000, 0x0000 }, { 0x01c9, 0x0000, 0x0000 }, { 0x01ca, 0x0000, 0x0000 }, { 0x01cb, 0x0000, 0x0000 }, // U+01C8
+    { 0x01cc, 0x0000, 0x0000 }, { 0x0041, 0x030c, 0x0000 }, { 0x0061, 0x030c, 0x0000 }, { 0x0049, 0x030c, 0x0000 }, // U+01CC
+    { 0x0069, 0x030c, 0x0000 }, { 0x004f, 0x030c, 0x0000 }, { 0x006f, 0x030c, 0x0000 }, { 0x0055, 0x030c, 0x0000 }, // U+01D0
+    { 0x0075, 0x030c, 0x0000 }, { 0x0055, 0x0308, 0x0304 }, { 0x0075, 0x0308, 0x0304 }, { 0x0055, 0x0308, 0x0301 }, // U+01D4
+    { 0x0075, 0x0308, 0x0301 }, { 0x0055, 0x0308, 0x030c }, { 0x0075, 0x0308, 0x030c }, { 0x0055, 0x0308, 0x0300 }, // U+01D8
+    { 0x0075, 0x0308, 0x0300 }, { 0x01dd, 0x0000, 0x0000 }, { 0x0041, 0x0308, 0x0304 }, { 0x0061, 0x0308, 0x0304 }, // U+01DC
+    { 0x0041, 0x0307, 0x0304 }, { 0x0061, 0x0307, 0x0304 }, { 0x00c6, 0x0304, 0x0000 }, { 0x00e6, 0x0304, 0x0000 }, // U+01E0
+    { 0x01e4, 0x0000, 0x0000 }, { 0x01e5, 0x0000, 0x0000 }, { 0x0047, 0x030c, 0x0000 }, { 0x0067, 0x030c, 0x0000 }, // U+01E4
+    { 0x004b, 0x030c, 0x0000 }, { 0x006b, 0x030c, 0x0000 }, { 0x004f, 0x0328, 0x0000 }, { 0x006f, 0x0328, 0x0000 }, // U+01E8
+    { 0x004f, 0x0328, 0x0304 }, { 0x006f, 0x0328, 0x0304 }, { 0x01b7, 0x030c, 0x0000 }, { 0x0292, 0x030c, 0x0000 }, // U+01EC
+    { 0x006a, 0x030c, 0x0000 }, { 0x01f1, 0x0000, 0x0000 }, { 0x01f2, 0x0000, 0x0000 }, { 0x01f3, 0x0000, 0x0000 }, // U+01F0
+    { 0x0047, 0x0301, 0x0000 }, { 0x0067, 0x0301, 0x0000 }, { 0x01f6, 0x0000, 0x0000 }, { 0x01f7, 0x0000, 0x0000 }, // U+01F4
+    { 0x004e, 0x0300, 0x0000 }, { 0x006e, 0x0300, 0x0000 }, { 0x0041, 0x030a, 0x0301 }, { 0x0061, 0x030a, 0x0301 }, // U+01F8
+    { 0x00c6, 0x0301, 0x0000 }, { 0x00e6, 0x0301, 0x0000 }, { 0x00d8, 0x0301, 0x0000 }, { 0x00f8, 0x0301, 0x0000 }, // U+01FC
+    { 0x0041, 0x030f, 0x0000 }, { 0x0061, 0x030f, 0x0000 }, { 0x0041, 0x0311, 0x0000 }, { 0x0061, 0x0311, 0x0000 }, // U+0200
+    { 0x0045, 0x030f, 0x0000 }, { 0x0065, 0x030f, 0x0000 }, { 0x0045, 0x0311, 0x0000 }, { 0x0065, 0x0311, 0x0000 }, // U+0204
+    { 0x0049, 0x030f, 0x0000 }, { 0x0069, 0x030f, 0x0000 }, { 0x0049, 0x0311, 0x0000 }, { 0x0069, 0x0311, 0x0000 }, // U+0208
+    { 0x004f, 0x030f, 0x0000 }, { 0x006f, 0x030f, 0x0000 }, { 0x004f, 0x0311, 0x0000 }, { 0x006f, 0x0311, 0x0000 }, // U+020C
+    { 0x0052, 0x030f, 0x0000 }, { 0x0072, 0x030f, 0x0000 }, { 0x0052, 0x0311, 0x0000 }, { 0x0072, 0x0311, 0x0000 }, // U+0210
+    { 0x0055, 0x030f, 0x0000 }, { 0x0075, 0x030f, 0x0000 }, { 0x0055, 0x0311, 0x0000 }, { 0x0075, 0x0311, 0x0000 }, // U+0214
+    { 0x0053, 0x0326, 0x0000 }, { 0x0073, 0x0326, 0x0000 }, { 0x0054, 0x0326, 0x0000 }, { 0x0074, 0x0326, 0x0000 }, // U+0218
+    { 0x021c, 0x0000, 0x0000 }, { 0x021d, 0x0000, 0x0000 }, { 0x0048, 0x030c, 0x0000 }, { 0x0068, 0x030c, 0x0000 }, // U+021C
+    { 0x0220, 0x0000, 0x0000 }, { 0x0221, 0x0000, 0x0000 }, { 0x0222, 0x0000, 0x0000 }, { 0x0223, 0x0000, 0x0000 }, // U+0220
+    { 0x0224, 0x0000, 0x0000 }, { 0x0225, 0x0000, 0x0000 }, { 0x0041, 0x0307, 0x0000 }, { 0x0061, 0x0307, 0x0000 }, // U+0224
+    { 0x0045, 0x0327, 0x0000 }, { 0x0065, 0x0327, 0x0000 }, { 0x004f, 0x0308, 0x0304 }, { 0x006f, 0x0308, 0x0304 }, // U+0228
+    { 0x004f, 0x0303, 0x0304 }, { 0x006f, 0x0303, 0x0304 }, { 0x004f, 0x0307, 0x0000 }, { 0x006f, 0x0307, 0x0000 }, // U+022C
+    { 0x004f, 0x0307, 0x0304 }, { 0x006f, 0x0307, 0x0304 }, { 0x0059, 0x0304, 0x0000 }, { 0x0079, 0x0304, 0x0000 }, // U+0230
+    { 0x0234, 0x0000, 0x0000 }, { 0x0235, 0x0000, 0x0000 }, { 0x0236, 0x0000, 0x0000 }, { 0x0237, 0x0000, 0x0000 }, // U+0234
+    { 0x0238, 0x0000, 0x0000 }, { 0x0239, 0x0000, 0x0000 }, { 0x023a, 0x0000, 0x0000 }, { 0x023b, 0x0000, 0x0000 }, // U+0238
+    { 0x023c, 0x0000, 0x0000 }, { 0x023d, 0x0000, 0x0000 }, { 0x023e, 0x0000, 0x0000 }, { 0x023f, 0x0000, 0x0000 }, // U+023C
+    { 0x0240, 0x0000, 0x0000 }, { 0x0241, 0x0000, 0x0000 }, { 0x0242, 0x0000, 0x0000 }, { 0x0243, 0x0000, 0x0000 }, // U+0240
+    { 0x0244, 0x0000, 0x0000 }, { 0x0245, 0x0000, 0x0000 }, { 0x0246, 0x0000, 0x0000 }, { 0x0247, 0x0000, 0x0000 }, // U+0244
+    { 0x0248, 0x0000, 0x0000 }, { 0x0249, 0x0000, 0x0000 }, { 0x024a, 0x0000, 0x0000 }, { 0x024b, 0x0000, 0x0000 }, // U+0248
+    { 0x024c, 0x0000, 0x0000 }, { 0x024d, 0x0000, 0x0000 }, { 0x024e, 0x0000, 0x0000 }, { 0x024f, 0x0000, 0x0000 }, // U+024C
+};
+
+// U+1E00 to U+1EFF: Latin Extended Additional
+constexpr ushort latinAdditionalFoldingsBegin = 0x1e00;
+constexpr ushort latinAdditionalFoldings[][3] = {
+    { 0x0041, 0x0325, 0x0000 }, { 0x0061, 0x0325, 0x0000 }, { 0x0042, 0x0307, 0x0000 }, { 0x0062, 0x0307, 0x0000 }, // U+1E00
+    { 0x0042, 0x0323, 0x0000 }, { 0x0062, 0x0323, 0x0000 }, { 0x0042, 0x0331, 0x0000 }, { 0x0062, 0x0331, 0x0000 }, // U+1E04
+    { 0x0043, 0x0327, 0x0301 }, { 0x0063, 0x0327, 0x0301 }, { 0x0044, 0x0307, 0x0000 }, { 0x0064, 0x0307, 0x0000 }, // U+1E08
+    { 0x0044, 0x0323, 0x0000 }, { 0x0064, 0x0323, 0x0000 }, { 0x0044, 0x0331, 0x0000 }, { 0x0064, 0x0331, 0x0000 }, // U+1E0C
+    { 0x0044, 0x0327, 0x0000 }, { 0x0064, 0x0327, 0x0000 }, { 0x0044, 0x032d, 0x0000 }, { 0x0064, 0x032d, 0x0000 }, // U+1E10
+    { 0x0045, 0x0304, 0x0300 }, { 0x0065, 0x0304, 0x0300 }, { 0x0045, 0x0304, 0x0301 }, { 0x0065, 0x0304, 0x0301 }, // U+1E14
+    { 0x0045, 0x032d, 0x0000 }, { 0x0065, 0x032d, 0x0000 }, { 0x0045, 0x0330, 0x0000 }, { 0x0065, 0x0330, 0x0000 }, // U+1E18
+    { 0x0045, 0x0327, 0x0306 }, { 0x0065, 0x0327, 0x0306 }, { 0x0046, 0x0307, 0x0000 }, { 0x0066, 0x0307, 0x0000 }, // U+1E1C
+    { 0x0047, 0x0304, 0x0000 }, { 0x0067, 0x0304, 0x0000 }, { 0x0048, 0x0307, 0x0000 }, { 0x0068, 0x0307, 0x0000 }, // U+1E20
+    { 0x0048, 0x0323, 0x0000 }, { 0x0068, 0x0323, 0x0000 }, { 0x0048, 0x0308, 0x0000 }, { 0x0068, 0x0308, 0x0000 }, // U+1E24
+    { 0x0048, 0x0327, 0x0000 }, { 0x0068, 0x0327, 0x0000 }, { 0x0048, 0x032e, 0x0000 }, { 0x0068, 0x032e, 0x0000 }, // U+1E28
+    { 0x0049, 0x0330, 0x0000 }, { 0x0069, 0x0330, 0x0000 }, { 0x0049, 0x0308, 0x0301 }, { 0x0069, 0x0308, 0x0301 }, // U+1E2C
+    { 0x004b, 0x0301, 0x0000 }, { 0x006b, 0x0301, 0x0000 }, { 0x004b, 0x0323, 0x0000 }, { 0x006b, 0x0323, 0x0000 }, // U+1E30
+    { 0x004b, 0x0331, 0x0000 }, { 0x006b, 0x0331, 0x0000 }, { 0x004c, 0x0323, 0x0000 }, { 0x006c, 0x0323, 0x0000 }, // U+1E34
+    { 0x004c, 0x0323, 0x0304 }, { 0x006c, 0x0323, 0x0304 }, { 0x004c, 0x0331, 0x0000 }, { 0x006c, 0x0331, 0x0000 }, // U+1E38
+    { 0x004c, 0x032d, 0x0000 }, { 0x006c, 0x032d, 0x0000 }, { 0x004d, 0x0301, 0x0000 }, { 0x006d, 0x0301, 0x0000 }, // U+1E3C
+    { 0x004d, 0x0307, 0x0000 }, { 0x006d, 0x0307, 0x0000 }, { 0x004d, 0x0323, 0x0000 }, { 0x006d, 0x0323, 0x0000 }, // U+1E40
+    { 0x004e, 0x0307, 0x0000 }, { 0x006e, 0x0307, 0x0000 }, { 0x004e, 0x0323, 0x0000 }, { 0x006e, 0x0323, 0x0000 }, // U+1E44
+    { 0x004e, 0x0331, 0x0000 }, { 0x006e, 0x0331, 0x0000 }, { 0x004e, 0x032d, 0x0000 }, { 0x006e, 0x032d, 0x0000 }, // U+1E48
+    { 0x004f, 0x0303, 0x0301 }, { 0x006f, 0x0303, 0x0301 }, { 0x004f, 0x0303, 0x0308 }, { 0x006f, 0x0303, 0x0308 }, // U+1E4C
+    { 0x004f, 0x0304, 0x0300 }, { 0x006f, 0x0304, 0x0300 }, { 0x004f, 0x0304, 0x0301 }, { 0x006f, 0x0304, 0x0301 }, // U+1E50
+    { 0x0050, 0x0301, 0x0000 }, { 0x0070, 0x0301, 0x0000 }, { 0x0050, 0x0307, 0x0000 }, { 0x0070, 0x0307, 0x0000 }, // U+1E54
+    { 0x0052, 0x0307, 0x0000 }, { 0x0072, 0x0307, 0x0000 }, { 0x0052, 0x0323, 0x0000 }, { 0x0072, 0x0323, 0x0000 }, // U+1E58
+    { 0x0052, 0x0323, 0x0304 }, { 0x0072, 0x0323, 0x0304 }, { 0x0052, 0x0331, 0x0000 }, { 0x0072, 0x0331, 0x0000 }, // U+1E5C
+    { 0x0053, 0x0307, 0x0000 }, { 0x0073, 0x0307, 0x0000 }, { 0x0053, 0x0323, 0x0000 }, { 0x0073, 0x0323, 0x0000 }, // U+1E60
+    { 0x0053, 0x0301, 0x0307 }, { 0x0073, 0x0301, 0x0307 }, { 0x0053, 0x030c, 0x0307 }, { 0x0073, 0x030c, 0x0307 }, // U+1E64
+    { 0x0053, 0x0323, 0x0307 }, { 0x0073, 0x0323, 0x0307 }, { 0x0054, 0x0307, 0x0000 }, { 0x0074, 0x0307, 0x0000 }, // U+1E68
+    { 0x0054, 0x0323, 0x0000 }, { 0x0074, 0x0323, 0x0000 }, { 0x0054, 0x0331, 0x0000 }, { 0x0074, 0x0331, 0x0000 }, // U+1E6C
+    { 0x0054, 0x032d, 0x0000 }, { 0x0074, 0x032d, 0x0000 }, { 0x0055, 0x0324, 0x0000 }, { 0x0075, 0x0324, 0x0000 }, // U+1E70
+    { 0x0055, 0x0330, 0x0000 }, { 0x0075, 0x0330, 0x0000 }, { 0x0055, 0x032d, 0x0000 }, { 0x0075, 0x032d, 0x0000 }, // U+1E74
+    { 0x0055, 0x0303, 0x0301 }, { 0x0075, 0x0303, 0x0301 }, { 0x0055, 0x0304, 0x0308 }, { 0x0075, 0x0304, 0x0308 }, // U+1E78
+    { 0x0056, 0x0303, 0x0000 }, { 0x0076, 0x0303, 0x0000 }, { 0x0056, 0x0323, 0x0000 }, { 0x0076, 0x0323, 0x0000 }, // U+1E7C
+    { 0x0057, 0x0300, 0x0000 }, { 0x0077, 0x0300, 0x0000 }, { 0x0057, 0x0301, 0x0000 }, { 0x0077, 0x0301, 0x0000 }, // U+1E80
+    { 0x0057, 0x0308, 0x0000 }, { 0x0077, 0x0308, 0x0000 }, { 0x0057, 0x0307, 0x0000 }, { 0x0077, 0x0307, 0x0000 }, // U+1E84
+    { 0x0057, 0x0323, 0x0000 }, { 0x0077, 0x0323, 0x0000 }, { 0x0058, 0x0307, 0x0000 }, { 0x0078, 0x0307, 0x0000 }, // U+1E88
+    { 0x0058, 0x0308, 0x0000 }, { 0x0078, 0x0308, 0x0000 }, { 0x0059, 0x0307, 0x0000 }, { 0x0079, 0x0307, 0x0000 }, // U+1E8C
+    { 0x005a, 0x0302, 0x0000 }, { 0x007a, 0x0302, 0x0000 }, { 0x005a, 0x0323, 0x0000 }, { 0x007a, 0x0323, 0x0000 }, // U+1E90
+    { 0x005a, 0x0331, 0x0000 }, { 0x007a, 0x0331, 0x0000 }, { 0x0068, 0x0331, 0x0000 }, { 0x0074, 0x0308, 0x0000 }, // U+1E94
+    { 0x0077, 0x030a, 0x0000 }, { 0x0079, 0x030a, 0x0000 }, { 0x1e9a, 0x0000, 0x0000 }, { 0x017f, 0x0307, 0x0000 }, // U+1E98
+    { 0x1e9c, 0x0000, 0x0000 }, { 0x1e9d, 0x0000, 0x0000 }, { 0x1e9e, 0x0000, 0x0000 }, { 0x1e9f, 0x0000, 0x0000 }, // U+1E9C
+    { 0x0041, 0x0323, 0x0000 }, { 0x0061, 0x0323, 0x0000 }, { 0x0041, 0x0309, 0x0000 }, { 0x0061, 0x0309, 0x0000 }, // U+1EA0
+    { 0x0041, 0x0302, 0x0301 }, { 0x0061, 0x0302, 0x0301 }, { 0x0041, 0x0302, 0x0300 }, { 0x0061, 0x0302, 0x0300 }, // U+1EA4
+    { 0x0041, 0x0302, 0x0309 }, { 0x0061, 0x0302, 0x0309 }, { 0x0041, 0x0302, 0x0303 }, { 0x0061, 0x0302, 0x0303 }, // U+1EA8
+    { 0x0041, 0x0323, 0x0302 }, { 0x0061, 0x0323, 0x0302 }, { 0x0041, 0x0306, 0x0301 }, { 0x0061, 0x0306, 0x0301 }, // U+1EAC
+    { 0x0041, 0x0306, 0x0300 }, { 0x0061, 0x0306, 0x0300 }, { 0x0041, 0x0306, 0x0309 }, { 0x0061, 0x0306, 0x0309 }, // U+1EB0
+    { 0x0041, 0x0306, 0x0303 }, { 0x0061, 0x0306, 0x0303 }, { 0x0041, 0x0323, 0x0306 }, { 0x0061, 0x0323, 0x0306 }, // U+1EB4
+    { 0x0045, 0x0323, 0x0000 }, { 0x0065, 0x0323, 0x0000 }, { 0x0045, 0x0309, 0x0000 }, { 0x0065, 0x0309, 0x0000 }, // U+1EB8
+    { 0x0045, 0x0303, 0x0000 }, { 0x0065, 0x0303, 0x0000 }, { 0x0045, 0x0302, 0x0301 }, { 0x0065, 0x0302, 0x0301 }, // U+1EBC
+    { 0x0045, 0x0302, 0x0300 }, { 0x0065, 0x0302, 0x0300 }, { 0x0045, 0x0302, 0x0309 }, { 0x0065, 0x0302, 0x0309 }, // U+1EC0
+    { 0x0045, 0x0302, 0x0303 }, { 0x0065, 0x0302, 0x0303 }, { 0x0045, 0x0323, 0x0302 }, { 0x0065, 0x0323, 0x0302 }, // U+1EC4
+    { 0x0049, 0x0309, 0x0000 }, { 0x0069, 0x0309, 0x0000 }, { 0x0049, 0x0323, 0x0000 }, { 0x0069, 0x0323, 0x0000 }, // U+1EC8
+    { 0x004f, 0x0323, 0x0000 }, { 0x006f, 0x0323, 0x0000 }, { 0x004f, 0x0309, 0x0000 }, { 0x006f, 0x0309, 0x0000 }, // U+1ECC
+    { 0x004f, 0x0302, 0x0301 }, { 0x006f, 0x0302, 0x0301 }, { 0x004f, 0x0302, 0x0300 }, { 0x006f, 0x0302, 0x0300 }, // U+1ED0
+    { 0x004f, 0x0302, 0x0309 }, { 0x006f, 0x0302, 0x0309 }, { 0x004f, 0x0302, 0x0303 }, { 0x006f, 0x0302, 0x0303 }, // U+1ED4
+    { 0x004f, 0x0323, 0x0302 }, { 0x006f, 0x0323, 0x0302 }, { 0x004f, 0x031b, 0x0301 }, { 0x006f, 0x031b, 0x0301 }, // U+1ED8
+    { 0x004f, 0x031b, 0x0300 }, { 0x006f, 0x031b, 0x0300 }, { 0x004f, 0x031b, 0x0309 }, { 0x006f, 0x031b, 0x0309 }, // U+1EDC
+    { 0x004f, 0x031b, 0x0303 }, { 0x006f, 0x031b, 0x0303 }, { 0x004f, 0x031b, 0x0323 }, { 0x006f, 0x031b, 0x0323 }, // U+1EE0
+    { 0x0055, 0x0323, 0x0000 }, { 0x0075, 0x0323, 0x0000 }, { 0x0055, 0x0309, 0x0000 }, { 0x0075, 0x0309, 0x0000 }, // U+1EE4
+    { 0x0055, 0x031b, 0x0301 }, { 0x0075, 0x031b, 0x0301 }, { 0x0055, 0x031b, 0x0300 }, { 0x0075, 0x031b, 0x0300 }, // U+1EE8
+    { 0x0055, 0x031b, 0x0309 }, { 0x0075, 0x031b, 0x0309 }, { 0x0055, 0x031b, 0x0303 }, { 0x0075, 0x031b, 0x0303 }, // U+1EEC
+    { 0x0055, 0x031b, 0x0323 }, { 0x0075, 0x031b, 0x0323 }, { 0x0059, 0x0300, 0x0000 }, { 0x0079, 0x0300, 0x0000 }, // U+1EF0
+    { 0x0059, 0x0323, 0x0000 }, { 0x0079, 0x0323, 0x0000 }, { 0x0059, 0x0309, 0x0000 }, { 0x0079, 0x0309, 0x0000 }, // U+1EF4
+    { 0x0059, 0x0303, 0x0000 }, { 0x0079, 0x0303, 0x0000 }, { 0x1efa, 0x0000, 0x0000 }, { 0x1efb, 0x0000, 0x0000 }, // U+1EF8
+    { 0x1efc, 0x0000, 0x0000 }, { 0x1efd, 0x0000, 0x0000 }, { 0x1efe, 0x0000, 0x0000 }, { 0x1eff, 0x0000, 0x0000 }, // U+1EFC
+};
+
+static_assert(sizeof(latinFoldings) / sizeof(latinFoldings[0]) == 0x0250 - latinFoldingsBegin,
+              "one entry per character");
+static_assert(sizeof(latinAdditionalFoldings) / sizeof(latinAdditionalFoldings[0]) == 0x1f00 - latinAdditionalFoldingsBegin,
+              "one entry per character");
+
+// Returns the decomposition of the character, or nullptr if it is not a precomposed Latin letter
+inline const ushort *latinDecomposition(ushort c)
+{
+    if (c >= latinFoldingsBegin && c < latinFoldingsBegin + sizeof(latinFoldings) / sizeof(latinFoldings[0]))
+        return latinFoldings[c - latinFoldingsBegin];
+    if (c >= latinAdditionalFoldingsBegin && c < latinAdditionalFoldingsBegin + sizeof(latinAdditionalFoldings) / sizeof(latinAdditionalFoldings[0]))
+        return latinAdditionalFoldings[c - latinAdditionalFoldingsBegin];
+    return nullptr;
+}
+
+#endif
@@ -31,7 +31,11 @@
  */
 
 #include "seasidefilteredmodel.h"
+#include "seasidecharacterfolding.h"
 #include "seasideperson.h"
+#include "seasidesearchprewarmer.h"
+#include "seasidesubstringsearch.h"
+#include "synchronizelists.h"
 
 #include <qtcontacts-extensions.h>
 #include <qtcontacts-extensions_impl.h>
@@ -54,11 +58,20 @@
 #include <MLocale>
 #include <MBreakIterator>
 
+#include <QCache>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QEvent>
+#include <QPointer>
+#include <QThread>
 #include <QVector>
+#include <QtConcurrentMap>
 #include <QtDebug>
 
+#include <algorithm>
+#include <limits>
+
 namespace {
 
 const QByteArray displayLabelRole("displayLabel");
@@ -88,9 +101,31 @@ const QByteArray roleRole("role");
 const QByteArray nameDetailsRole("nameDetails");
 const QByteArray filterMatchDataRole("filterMatchData");
 const QByteArray addressBookRole("addressBook");
+const QByteArray filterMatchRangesRole("filterMatchRanges");
 
 const ML10N::MLocale mLocale;
 
+// Posted to continue an asynchronous search
+const QEvent::Type searchEventType = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+// The number of results published when an asynchronous or ranked search is evaluated
+const int initialResultCount = 50;
+// The number of results appended in each later step of an asynchronous search
+const int resultBatchSize = 200;
+// The number of contacts added to the search index in each step of an asynchronous search
+const int indexBatchSize = 1000;
+
+// The score of a match in each priority; differences in match position never outweigh this
+const int priorityScore = 100;
+// The score added to favorite contacts in a ranked search
+const int favoriteScore = 100;
+// The score added to contacts for each recorded use, up to usageCountLimit uses
+const int usageCountScore = 10;
+const int usageCountLimit = 10;
+// The score added to a contact just used, halving after usageRecencyPeriod
+const int usageRecencyScore = 100;
+const qint64 usageRecencyPeriod = 24 * 60 * 60 * 1000;
+
 template<typename T>
 void insert(QList<T> &dst, const QList<T> &src)
 {
@@ -109,38 +144,234 @@ QSet<QString> alphabetCharacters()
     return rv;
 }
 
-QMap<uint, QString> decompositionMapping()
+struct Decomposition {
+    ushort codePoint;
+    const char *alternative;
+};
+
+// Alternative spellings for characters that do not decompose; sorted by code point
+constexpr Decomposition decompositions[] = {
+    { 0x00df, "ss" }, // sharp-s ('sz' ligature)
+    { 0x00e6, "ae" }, // 'ae' ligature
+    { 0x00f0, "d" },  // eth
+    { 0x00f8, "o" },  // o with stroke
+    { 0x00fe, "th" }, // thorn
+    { 0x0111, "d" },  // d with stroke
+    { 0x0127, "h" },  // h with stroke
+    { 0x0138, "k" },  // kra
+    { 0x0142, "l" },  // l with stroke
+    { 0x014b, "n" },  // eng
+    { 0x0153, "oe" }, // 'oe' ligature
+    { 0x0167, "t" },  // t with stroke
+    { 0x017f, "s" },  // long s
+};
+
+constexpr bool decompositionsSorted(int i = 1)
+{
+    return i >= int(sizeof(decompositions) / sizeof(decompositions[0]))
+            || (decompositions[i - 1].codePoint < decompositions[i].codePoint && decompositionsSorted(i + 1));
+}
+static_assert(decompositionsSorted(), "decompositions must be sorted by code point");
+
+const char *decompositionAlternative(uint codePoint)
+{
+    const Decomposition *end = decompositions + sizeof(decompositions) / sizeof(decompositions[0]);
+    const Decomposition *it = std::lower_bound(decompositions, end, codePoint,
+                                               [](const Decomposition &d, uint cp) { return d.codePoint < cp; });
+    return (it != end && it->codePoint == codePoint) ? it->alternative : nullptr;
+}
+
+// Non-spacing marks below this code point are all in the combining diacritical marks block
+constexpr ushort combiningMarksBegin = 0x0300;
+constexpr ushort combiningMarksEnd = 0x0370;
+
+inline bool isNonSpacingMark(const QChar &c)
+{
+    const ushort u = c.unicode();
+    if (u < combiningMarksBegin)
+        return false;
+    if (u < combiningMarksEnd)
+        return true;
+    return c.category() == QChar::Mark_NonSpacing;
+}
+
+// Returns s without any non-spacing marks, sharing the data of s if it contains none
+QString stripMarks(const QString &s)
 {
-    QMap<uint, QString> rv;
+    const QChar *begin = s.cbegin(), *end = s.cend();
+    const QChar *it = std::find_if(begin, end, isNonSpacingMark);
+    if (it == end)
+        return s;
+
+    QString rv;
+    rv.reserve(s.size());
+    rv.append(begin, it - begin);
+    for ( ; it != end; ++it) {
+        if (!isNonSpacingMark(*it))
+            rv.append(*it);
+    }
+    return rv;
+}
 
-    rv.insert(0x00df, QStringLiteral("ss")); // sharp-s ('sz' ligature)
-    rv.insert(0x00e6, QStringLiteral("ae")); // 'ae' ligature
-    rv.insert(0x00f0, QStringLiteral("d"));  // eth
-    rv.insert(0x00f8, QStringLiteral("o"));  // o with stroke
-    rv.insert(0x00fe, QStringLiteral("th")); // thorn
-    rv.insert(0x0111, QStringLiteral("d"));  // d with stroke
-    rv.insert(0x0127, QStringLiteral("h"));  // h with stroke
-    rv.insert(0x0138, QStringLiteral("k"));  // kra
-    rv.insert(0x0142, QStringLiteral("l"));  // l with stroke
-    rv.insert(0x014b, QStringLiteral("n"));  // eng
-    rv.insert(0x0153, QStringLiteral("oe")); // 'oe' ligature
-    rv.insert(0x0167, QStringLiteral("t"));  // t with stroke
-    rv.insert(0x017f, QStringLiteral("s"));  // long s
+// Dial pad keys of the letters of each script, in code point order: Latin as specified by
+// ITU E.161, and Cyrillic and Greek following their common keypad layouts
+constexpr char latinDialPadKeys[] = "22233344455566677778889999";          // a-z
+constexpr char cyrillicDialPadKeys[] = "22223333444455556666777788889999"; // U+0430-U+044F
+constexpr char greekDialPadKeys[] = "2223334445556667777888999";          // U+03B1-U+03C9
+static_assert(sizeof(latinDialPadKeys) == 26 + 1, "one key per Latin letter");
+static_assert(sizeof(cyrillicDialPadKeys) == 32 + 1, "one key per Cyrillic letter");
+static_assert(sizeof(greekDialPadKeys) == 25 + 1, "one key per Greek letter");
+
+// Returns the dial pad key for a lower case character, or the character itself if it has none
+QChar dialPadKey(const QChar &c, bool decompose = true)
+{
+    const ushort u = c.unicode();
+    if (u >= 'a' && u <= 'z')
+        return QLatin1Char(latinDialPadKeys[u - 'a']);
+    if (u < 0x80)
+        return c; // Digits and dial pad symbols represent themselves
+    if (u >= 0x0430 && u <= 0x044f)
+        return QLatin1Char(cyrillicDialPadKeys[u - 0x0430]);
+    if (u == 0x0451)
+        return QLatin1Char('3'); // io
+    if (u >= 0x03b1 && u <= 0x03c9)
+        return QLatin1Char(greekDialPadKeys[u - 0x03b1]);
+
+    // Letters of the locale alphabet are not decomposed in search keys, but share
+    // the key of their base letter
+    if (decompose) {
+        const QString decomposition(c.decomposition());
+        if (!decomposition.isEmpty())
+            return dialPadKey(decomposition.at(0), false);
+    }
+    return c;
+}
 
+// Returns the dial pad keys of each character of s
+QString dialPadKeys(const QString &s)
+{
+    QString rv(s);
+    for (QChar &c : rv)
+        c = dialPadKey(c);
     return rv;
 }
 
-QStringList tokenize(const QString &word)
+// Returns the number of edits tolerated by a fuzzy match of a term of this length
+int fuzzyMatchDistance(int length)
+{
+    return length < 4 ? 0 : (length < 8 ? 1 : 2);
+}
+
+// Returns the edit distances from each prefix of value to a key extended by c, given
+// the distances for the key without c
+void advanceEditDistances(const QVector<int> &row, const QChar &c, const QString &value, QVector<int> *nextRow)
+{
+    (*nextRow)[0] = row[0] + 1;
+    for (int i = 1; i < row.size(); ++i) {
+        const int substitution = row[i - 1] + (value.at(i - 1) == c ? 0 : 1);
+        (*nextRow)[i] = std::min({ row[i] + 1, (*nextRow)[i - 1] + 1, substitution });
+    }
+}
+
+QVector<int> initialEditDistances(const QString &value)
+{
+    QVector<int> row(value.size() + 1);
+    for (int i = 0; i < row.size(); ++i)
+        row[i] = i;
+    return row;
+}
+
+// Appends the possible matches of a character to each of the tokens: the first match extends
+// the existing tokens, and each alternative extends a copy of them
+void appendMatches(QStringList *tokens, const QStringList &matches)
+{
+    if (tokens->isEmpty()) {
+        tokens->append(QString());
+    }
+
+    const int previousCount = tokens->count();
+    for (int i = 1; i < matches.count(); ++i) {
+        // Make an additional copy of the existing tokens, for each new possible match
+        for (int j = 0; j < previousCount; ++j) {
+            tokens->append(tokens->at(j) + matches.at(i));
+        }
+    }
+    for (int j = 0; j < previousCount; ++j) {
+        (*tokens)[j].append(matches.at(0));
+    }
+}
+
+// Tokenizes a word of ASCII and precomposed Latin letters using the static folding tables,
+// without break iteration or normalization; these characters are already in canonical form,
+// and each is a grapheme. Returns false if the word contains any other character.
+bool tokenizeLatin(const QString &word, const QSet<QString> &alphabet, QStringList *tokens)
+{
+    QStringList rv;
+    QString plain;
+    plain.reserve(word.size() * 2);
+
+    for (const QChar &c : word) {
+        const ushort u = c.unicode();
+        if (u < 0x80) {
+            plain.append(c);
+            continue;
+        }
+
+        const ushort *decomposition = latinDecomposition(u);
+        if (!decomposition)
+            return false;
+
+        if (alphabet.contains(QString(c))) {
+            // This character is a member of the alphabet for this locale - do not decompose it
+            plain.append(c);
+            continue;
+        }
+
+        // Decompose the character, to assist with diacritic-insensitive matching
+        QString normalized;
+        for (int i = 0; i < 3 && decomposition[i]; ++i)
+            normalized.append(QChar(decomposition[i]));
+
+        const char *alternative = decompositionAlternative(decomposition[0]);
+        if (!alternative) {
+            plain.append(normalized);
+            continue;
+        }
+
+        // This character has an alternative spelling, so the tokens diverge here
+        if (!plain.isEmpty()) {
+            appendMatches(&rv, QStringList(plain));
+            plain.clear();
+        }
+        appendMatches(&rv, QStringList() << normalized << QLatin1String(alternative));
+    }
+
+    if (!plain.isEmpty())
+        appendMatches(&rv, QStringList(plain));
+
+    *tokens = rv;
+    return true;
+}
+
+QStringList tokenize(const QString &word, const ML10N::MLocale &locale = mLocale)
 {
     static const QSet<QString> alphabet(alphabetCharacters());
-    static const QMap<uint, QString> decompositions(decompositionMapping());
+
+    // ASCII text is already canonical, and has no decompositions or alternatives
+    const bool ascii = std::all_of(word.cbegin(), word.cend(), [](const QChar &c) { return c.unicode() < 0x80; });
+    if (ascii)
+        return word.isEmpty() ? QStringList() : QStringList(word);
+
+    QStringList latinTokens;
+    if (tokenizeLatin(word, alphabet, &latinTokens))
+        return latinTokens;
 
     // Convert the word to canonical form, lowercase
     QString canonical(word.normalized(QString::NormalizationForm_C));
 
     QStringList tokens;
 
-    ML10N::MBreakIterator it(mLocale, canonical, ML10N::MBreakIterator::CharacterIterator);
+    ML10N::MBreakIterator it(locale, canonical, ML10N::MBreakIterator::CharacterIterator);
     while (it.hasNext()) {
         const int position = it.next();
         const int nextPosition = it.peekNext();
@@ -159,75 +390,182 @@ QStringList tokenize(const QString &word)
                 // For some characters, we want to match alternative spellings that do not correspond
                 // to decomposition characters
                 const uint codePoint(normalized.at(0).unicode());
-                QMap<uint, QString>::const_iterator dit = decompositions.find(codePoint);
-                if (dit != decompositions.end()) {
-                    matches.append(*dit);
+                if (const char *alternative = decompositionAlternative(codePoint)) {
+                    matches.append(QLatin1String(alternative));
                 }
             }
 
-            if (tokens.isEmpty()) {
-                tokens.append(QString());
-            }
-
-            int previousCount = tokens.count();
-            for (int i = 1; i < matches.count(); ++i) {
-                // Make an additional copy of the existing tokens, for each new possible match
-                for (int j = 0; j < previousCount; ++j) {
-                    tokens.append(tokens.at(j) + matches.at(i));
-                }
-            }
-            for (int j = 0; j < previousCount; ++j) {
-                tokens[j].append(matches.at(0));
-            }
+            appendMatches(&tokens, matches);
         }
     }
 
     return tokens;
 }
 
-QList<const QString *> makeSearchToken(const QString &word)
+// Interns the search tokens of all contacts, so that each distinct token is stored once.
+// Tokens are reference counted, and freed when no filter keys refer to them; the pool
+// is owned by the cache, and is discarded when the cache expires.
+class SearchTokenPool : public QObject
 {
-    static QMap<uint, const QString *> indexedTokens;
-    static QHash<QString, QList<const QString *> > indexedWords;
+public:
+    static SearchTokenPool *instance(bool create = true)
+    {
+        static QPointer<SearchTokenPool> pool;
+        if (!pool && create) {
+            pool = new SearchTokenPool(SeasideCache::instance());
+        }
+        return pool;
+    }
+
+    // Returns the tokens for word; the caller must release each of them
+    QList<const QString *> makeSearchToken(const QString &word)
+    {
+        // Index all search text in lower case
+        const QString lowered(mLocale.toLower(word));
+
+        Word *indexed = m_words.object(lowered);
+        const bool cached = indexed != nullptr;
+        if (!cached) {
+            // Index these tokens for later dereferencing
+            indexed = new Word(this);
+            for (const QString &token : tokenize(lowered)) {
+                indexed->tokens.append(acquire(token));
+            }
+        }
+
+        const QList<const QString *> tokens(indexed->tokens);
+        for (const QString *token : tokens) {
+            acquire(*token);
+        }
+
+        if (!cached) {
+            // This may evict the least recently used words, releasing their tokens
+            m_words.insert(lowered, indexed);
+        }
+        return tokens;
+    }
+
+    // Returns the interned form of each token; the caller must release each of them
+    QList<const QString *> acquire(const QStringList &tokens)
+    {
+        QList<const QString *> rv;
+        rv.reserve(tokens.count());
+        for (const QString &token : tokens) {
+            rv.append(acquire(token));
+        }
+        return rv;
+    }
+
+    // Adds a reference to an interned token; the caller must release it
+    void retain(const QString *token) { acquire(*token); }
+
+    // Returns the text of an interned token, with any non-spacing marks removed
+    static const QString &folded(const QString *token)
+    {
+        // The text is the first member of its token
+        return reinterpret_cast<const Token *>(token)->folded;
+    }
 
-    // Index all search text in lower case
-    const QString lowered(mLocale.toLower(word));
+    static bool hasMarks(const QString *token) { return folded(token).size() != token->size(); }
 
-    QHash<QString, QList<const QString *> >::const_iterator wit = indexedWords.find(lowered);
-    if (wit == indexedWords.end()) {
-        QList<const QString *> indexed;
+    // Returns the dial pad keys of the folded text of an interned token
+    static const QString &dialPadKey(const QString *token)
+    {
+        const Token *interned = reinterpret_cast<const Token *>(token);
+        if (interned->dialPadKey.isNull()) {
+            // Only computed for tokens searched by dial pad keys
+            interned->dialPadKey = dialPadKeys(interned->folded);
+        }
+        return interned->dialPadKey;
+    }
 
-        // Index these tokens for later dereferencing
-        for (const QString &token : tokenize(lowered)) {
-            uint hashValue(qHash(token));
-            QMap<uint, const QString *>::const_iterator tit = indexedTokens.find(hashValue);
-            if (tit == indexedTokens.end()) {
-                tit = indexedTokens.insert(hashValue, new QString(token));
+    static void release(const QList<const QString *> &tokens)
+    {
+        if (SearchTokenPool *pool = instance(false)) {
+            for (const QString *token : tokens) {
+                pool->release(token);
+            }
+        }
+    }
+
+private:
+    static const int maxCachedWords = 2000;
+
+    // Holds a reference to the tokens of a recently tokenized word
+    struct Word {
+        explicit Word(SearchTokenPool *pool) : pool(pool) {}
+        ~Word()
+        {
+            for (const QString *token : tokens) {
+                pool->release(token);
             }
-            indexed.append(*tit);
         }
 
-        wit = indexedWords.insert(lowered, indexed);
+        SearchTokenPool *pool;
+        QList<const QString *> tokens;
+    };
+
+    struct Token {
+        QString text;
+        QString folded;
+        mutable QString dialPadKey;
+        int references;
+    };
+
+    explicit SearchTokenPool(QObject *parent)
+        : QObject(parent)
+        , m_words(maxCachedWords)
+    {
+    }
+
+    ~SearchTokenPool()
+    {
+        m_words.clear();
+        qDeleteAll(m_tokens);
     }
 
-    return *wit;
+    const QString *acquire(const QString &text)
+    {
+        Token *&token = m_tokens[text];
+        if (!token) {
+            token = new Token { text, stripMarks(text), QString(), 0 };
+        }
+        ++token->references;
+        return &token->text;
+    }
+
+    void release(const QString *text)
+    {
+        QHash<QString, Token *>::iterator it = m_tokens.find(*text);
+        if (it != m_tokens.end() && --(*it)->references == 0) {
+            Token *token = *it;
+            m_tokens.erase(it);
+            delete token;
+        }
+    }
+
+    QHash<QString, Token *> m_tokens;
+    QCache<QString, Word> m_words;
+};
+
+QList<const QString *> makeSearchToken(const QString &word)
+{
+    return SearchTokenPool::instance()->makeSearchToken(word);
 }
 
 // Splits a string at word boundaries identified by MBreakIterator
-QList<const QString *> splitWords(const QString &string)
+QStringList searchWords(const QString &string, const ML10N::MLocale &locale = mLocale)
 {
-    QList<const QString *> rv;
+    QStringList rv;
     if (!string.isEmpty()) {
         // Ignore any instances of '.' (frequently present in email addresses, but not useful)
         const QString dot(QStringLiteral("."));
-        ML10N::MBreakIterator it(mLocale, string, ML10N::MBreakIterator::WordIterator);
+        ML10N::MBreakIterator it(locale, string, ML10N::MBreakIterator::WordIterator);
         while (it.hasNext()) {
             const int position = it.next();
             const QString word(string.mid(position, (it.peekNext() - position)).trimmed());
             if (!word.isEmpty() && word != dot) {
-                for (const QString *alternative : makeSearchToken(word)) {
-                    rv.append(alternative);
-                }
+                rv.append(word);
             }
         }
     }
@@ -235,6 +573,31 @@ QList<const QString *> splitWords(const QString &string)
     return rv;
 }
 
+// Returns the interned tokens of each word in string; the returned tokens must be released
+QList<const QString *> splitWords(const QString &string)
+{
+    QList<const QString *> rv;
+    for (const QString &word : searchWords(string)) {
+        for (const QString *alternative : makeSearchToken(word)) {
+            rv.append(alternative);
+        }
+    }
+
+    return rv;
+}
+
+// Returns the tokens that splitWords() would produce, without interning them, so
+// that this can be called from any thread with its own locale instance
+QStringList splitWordTokens(const QString &string, const ML10N::MLocale &locale)
+{
+    QStringList rv;
+    for (const QString &word : searchWords(string, locale)) {
+        rv.append(tokenize(locale.toLower(word), locale));
+    }
+
+    return rv;
+}
+
 QList<QStringList> extractSearchTerms(const QString &string)
 {
     QList<QStringList> rv;
@@ -261,6 +624,43 @@ QList<QStringList> extractSearchTerms(const QString &string)
     return rv;
 }
 
+// Returns the dial pad keys of each word of string; any letters are replaced by their keys
+QList<QStringList> extractDialPadTerms(const QString &string)
+{
+    QList<QStringList> rv;
+    for (const QString &word : string.simplified().split(QLatin1Char(' '))) {
+        if (!word.isEmpty())
+            rv.append(QStringList() << dialPadKeys(stripMarks(mLocale.toLower(word))));
+    }
+    return rv;
+}
+
+// Folds a string to locate search terms within it, disregarding case and diacritics, and
+// optionally mapping letters to their dial pad keys. If positions is supplied, it receives
+// the position in the string of each character of the folded string.
+QString matchFolded(const QString &s, bool dialPad, bool phoneNumber, QVector<int> *positions = nullptr)
+{
+    QString rv;
+    rv.reserve(s.size());
+    for (int i = 0; i < s.size(); ++i) {
+        QChar c(s.at(i));
+        if (isNonSpacingMark(c))
+            continue;
+        // Phone numbers are searched without their punctuation
+        if (phoneNumber && !c.isLetterOrNumber() && c != QLatin1Char('+')
+                && c != QLatin1Char('*') && c != QLatin1Char('#'))
+            continue;
+
+        if (c.decompositionTag() == QChar::Canonical)
+            c = c.decomposition().at(0);
+        c = c.toLower();
+        rv.append(dialPad ? dialPadKey(c) : c);
+        if (positions)
+            positions->append(i);
+    }
+    return rv;
+}
+
 QString stringPreceding(const QString &s, const QChar &c)
 {
     int index = s.indexOf(c);
@@ -280,14 +680,6 @@ struct EqualIndirect {
     bool operator()(T lhs, T rhs) const { return *lhs == *rhs; }
 };
 
-struct FirstElementLessThanIndirect {
-    template<typename Container>
-    bool operator()(const Container *lhs, typename Container::const_iterator rhs) { return *lhs->cbegin() < *rhs; }
-
-    template<typename Container>
-    bool operator()(typename Container::const_iterator lhs, const Container *rhs) { return *lhs < *rhs->cbegin(); }
-};
-
 template<template <typename T> class Container, typename T>
 QVector<T> toSortedVector(Container<T> &src)
 {
@@ -301,6 +693,56 @@ QVector<T> toSortedVector(Container<T> &src)
     return dst;
 }
 
+// Returns the roles affected by a combination of SeasideCache::ItemDataChange values,
+// or an empty list if all roles may be affected
+QVector<int> changedRoles(quint32 changes)
+{
+    QVector<int> roles;
+    if (changes == SeasideCache::AllDataChanged)
+        return roles;
+
+    if (changes & SeasideCache::NameDataChanged) {
+        roles << Qt::DisplayRole
+              << SeasideFilteredModel::FirstNameRole
+              << SeasideFilteredModel::LastNameRole
+              << SeasideFilteredModel::SectionBucketRole
+              << SeasideFilteredModel::PrimaryNameRole
+              << SeasideFilteredModel::SecondaryNameRole
+              << SeasideFilteredModel::NicknameDetailsRole
+              << SeasideFilteredModel::NameDetailsRole;
+    }
+    if (changes & SeasideCache::AvatarDataChanged) {
+        roles << SeasideFilteredModel::AvatarRole
+              << SeasideFilteredModel::AvatarUrlRole;
+    }
+    if (changes & SeasideCache::PresenceDataChanged) {
+        roles << SeasideFilteredModel::GlobalPresenceStateRole
+              << SeasideFilteredModel::AccountDetailsRole;
+    }
+    if (changes & SeasideCache::FavoriteDataChanged) {
+        roles << SeasideFilteredModel::FavoriteRole;
+    }
+    if (changes & SeasideCache::AddressDataChanged) {
+        roles << SeasideFilteredModel::PhoneNumbersRole
+              << SeasideFilteredModel::EmailAddressesRole
+              << SeasideFilteredModel::AccountUrisRole
+              << SeasideFilteredModel::AccountPathsRole
+              << SeasideFilteredModel::PhoneDetailsRole
+              << SeasideFilteredModel::EmailDetailsRole
+              << SeasideFilteredModel::AccountDetailsRole;
+    }
+    if (changes & SeasideCache::OrganizationDataChanged) {
+        roles << SeasideFilteredModel::CompanyNameRole
+              << SeasideFilteredModel::TitleRole
+              << SeasideFilteredModel::RoleRole;
+    }
+    if (changes & SeasideCache::NoteDataChanged) {
+        roles << SeasideFilteredModel::NoteDetailsRole;
+    }
+
+    return roles;
+}
+
 QList<quint32> sortedContactIds(const QVector<QVector<quint32> > &priorityBucketContacts)
 {
     QList<quint32> retn;
@@ -312,18 +754,111 @@ QList<quint32> sortedContactIds(const QVector<QVector<quint32> > &priorityBucket
     return retn;
 }
 
+// Orders matches of a ranked search by descending score, then by reference list position
+qint64 rankKey(int score, int row)
+{
+    return -static_cast<qint64>(score) * (Q_INT64_C(1) << 32) + row;
+}
+
+// Returns the contact ids of the ranked matches in order. If limited, only the leading
+// matches are ordered, leaving the remainder in an unspecified order.
+QList<quint32> rankedContactIds(QVector<QPair<qint64, quint32> > *rankedMatches, int limit)
+{
+    if (limit >= 0 && limit < rankedMatches->count()) {
+        // Select the leading matches with a bounded heap, rather than sorting every match
+        std::partial_sort(rankedMatches->begin(), rankedMatches->begin() + limit, rankedMatches->end());
+    } else {
+        std::sort(rankedMatches->begin(), rankedMatches->end());
+    }
+
+    QList<quint32> retn;
+    retn.reserve(rankedMatches->count());
+    for (const QPair<qint64, quint32> &match : *rankedMatches)
+        retn.append(match.second);
+    return retn;
+}
+
+bool isFavorite(const SeasideCache::CacheItem *item)
+{
+    return item->contact.detail<QContactFavorite>().isFavorite();
+}
+
+// Records how often and how recently contacts have been used in this process, shared by all models
+class ContactUsage
+{
+public:
+    static ContactUsage *instance()
+    {
+        static ContactUsage usage;
+        return &usage;
+    }
+
+    void record(quint32 iid)
+    {
+        Usage &usage(m_usage[iid]);
+        usage.count = qMin(usage.count + 1, usageCountLimit);
+        usage.lastUse = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    int score(quint32 iid, qint64 now) const
+    {
+        QHash<quint32, Usage>::const_iterator it = m_usage.constFind(iid);
+        if (it == m_usage.cend())
+            return 0;
+
+        const qint64 age = qMax<qint64>(now - it->lastUse, 0);
+        return it->count * usageCountScore
+                + static_cast<int>(usageRecencyScore * usageRecencyPeriod / (usageRecencyPeriod + age));
+    }
+
+private:
+    struct Usage {
+        int count = 0;
+        qint64 lastUse = 0;
+    };
+
+    QHash<quint32, Usage> m_usage;
+};
+
+// Returns the score added to every match of the contact in a ranked search
+int contactScore(const SeasideCache::CacheItem *item, qint64 now)
+{
+    return (isFavorite(item) ? favoriteScore : 0) + ContactUsage::instance()->score(item->iid, now);
+}
+
 }
 
+// Stores the filter keys of a cache item; the keys are shared by all models, and do
+// not depend on the sort order, which only determines the priority of each match.
 struct FilterData : public SeasideCache::ItemListener
 {
     // Store additional filter keys with the cache item
     QVector<const QString *> presenceMatchKeys;
     QHash<SeasideFilteredModel::PeopleRoles, QVector<QVector<const QString *> > > wildMatchKeys;
-    bool sortLastNameFirst = false;
+    QList<const QString *> tokenReferences;
+    bool indexed = false;
+
+    ~FilterData() { clear(); }
+
+    void clear()
+    {
+        presenceMatchKeys.clear();
+        wildMatchKeys.clear();
+        SearchTokenPool::release(tokenReferences);
+        tokenReferences.clear();
+    }
+
+    // Keeps the tokens referenced by our keys
+    QList<const QString *> retain(const QList<const QString *> &tokens)
+    {
+        insert(tokenReferences, tokens);
+        return tokens;
+    }
 
     enum MatchOperation {
         StartsWith = 0,
-        Contains
+        Contains,
+        Fuzzy
     };
     struct FieldMatchOperationSortPriority {
         SeasideFilteredModel::PeopleRoles field;
@@ -345,7 +880,8 @@ struct FilterData : public SeasideCache::ItemListener
             { SeasideFilteredModel::NicknameDetailsRole,    Contains,       8 },
             { SeasideFilteredModel::EmailAddressesRole,     Contains,       9 },
             { SeasideFilteredModel::CompanyNameRole,        Contains,      10 },
-            { SeasideFilteredModel::PhoneNumbersRole,       Contains,      11 }
+            { SeasideFilteredModel::PhoneNumbersRole,       Contains,      11 },
+            { SeasideFilteredModel::NameDetailsRole,        Fuzzy,         12 }
         };
         static QVector<FieldMatchOperationSortPriority> lastNameFirst {
             { SeasideFilteredModel::LastNameRole,           StartsWith,     0 },
@@ -359,14 +895,28 @@ struct FilterData : public SeasideCache::ItemListener
             { SeasideFilteredModel::NicknameDetailsRole,    Contains,       8 },
             { SeasideFilteredModel::EmailAddressesRole,     Contains,       9 },
             { SeasideFilteredModel::CompanyNameRole,        Contains,      10 },
-            { SeasideFilteredModel::PhoneNumbersRole,       Contains,      11 }
+            { SeasideFilteredModel::PhoneNumbersRole,       Contains,      11 },
+            { SeasideFilteredModel::NameDetailsRole,        Fuzzy,         12 }
         };
         return sortLastNameFirst ? lastNameFirst : firstNameFirst;
     }
 
-    static FilterData *getItemFilterData(SeasideCache::CacheItem *item, const SeasideFilteredModel *model)
+    // Fuzzy matches of names are sorted after all exact matches
+    static constexpr int FuzzyMatchPriority = 12;
+
+    // Returns true if the tokens of this field are names, which may be matched fuzzily
+    static bool isFuzzyMatchField(int field)
+    {
+        return field == SeasideFilteredModel::FirstNameRole
+                || field == SeasideFilteredModel::LastNameRole
+                || field == SeasideFilteredModel::NameDetailsRole;
+    }
+
+    static FilterData *getItemFilterData(SeasideCache::CacheItem *item)
     {
-        void *key = const_cast<void *>(static_cast<const void *>(model));
+        static int filterDataKey;
+
+        void *key = &filterDataKey;
         SeasideCache::ItemListener *listener = item->listener(key);
         if (!listener) {
             listener = item->appendListener(new FilterData, key);
@@ -375,121 +925,153 @@ struct FilterData : public SeasideCache::ItemListener
         return static_cast<FilterData *>(listener);
     }
 
-    bool prepareFilter(SeasideCache::CacheItem *item, const QString &sortProperty = QString())
+    // A string of a contact from which filter keys are taken
+    struct FilterText {
+        int field;          // PresenceField, or the role whose keys are populated
+        QString text;
+        bool splitWords;    // Otherwise, the text is a single word
+    };
+
+    static const int PresenceField = -1;
+
+    // If not normalized, phone numbers are returned as they are stored
+    static QVector<FilterText> filterTexts(SeasideCache::CacheItem *item, bool normalizePhoneNumbers = true)
     {
         static const QChar atSymbol(QChar::fromLatin1('@'));
         static const QtContactsSqliteExtensions::NormalizePhoneNumberFlags normalizeFlags(
                     QtContactsSqliteExtensions::KeepPhoneNumberDialString
                     | QtContactsSqliteExtensions::ValidatePhoneNumber);
 
-        const bool sortByLastNameFirst = sortProperty.compare(QStringLiteral("lastName"), Qt::CaseInsensitive) == 0;
-        if (sortLastNameFirst != sortByLastNameFirst) {
-            sortLastNameFirst = sortByLastNameFirst;
-            wildMatchKeys.clear();
+        QVector<FilterText> texts;
+        texts.reserve(20);
+
+        // the presenceMatchKeys for this contact
+        for (const QContactOnlineAccount &detail : item->contact.details<QContactOnlineAccount>())
+            texts.append(FilterText { PresenceField, stringPreceding(detail.accountUri(), atSymbol), true });
+        for (const QContactGlobalPresence &detail : item->contact.details<QContactGlobalPresence>())
+            texts.append(FilterText { PresenceField, detail.nickname(), true });
+        for (const QContactPresence &detail : item->contact.details<QContactPresence>())
+            texts.append(FilterText { PresenceField, detail.nickname(), true });
+
+        // the wildMatchKeys for this contact
+        QContactName name = item->contact.detail<QContactName>();
+
+        texts.append(FilterText { SeasideFilteredModel::FirstNameRole, name.firstName(), true });
+        texts.append(FilterText { SeasideFilteredModel::LastNameRole, name.lastName(), true });
+
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, name.firstName(), true });
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, name.middleName(), true });
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, name.lastName(), true });
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, name.prefix(), true });
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, name.suffix(), true });
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, name.value<QString>(QContactName::FieldCustomLabel), true });
+        texts.append(FilterText { SeasideFilteredModel::NameDetailsRole, item->displayLabel, true });
+
+        for (const QContactNickname &detail : item->contact.details<QContactNickname>())
+            texts.append(FilterText { SeasideFilteredModel::NicknameDetailsRole, detail.nickname(), true });
+        for (const QContactEmailAddress &detail : item->contact.details<QContactEmailAddress>())
+            texts.append(FilterText { SeasideFilteredModel::EmailAddressesRole, detail.emailAddress(), true });
+        for (const QContactOrganization &detail : item->contact.details<QContactOrganization>())
+            texts.append(FilterText { SeasideFilteredModel::CompanyNameRole, detail.name(), true });
+        for (const QContactPhoneNumber &detail : item->contact.details<QContactPhoneNumber>()) {
+            if (!normalizePhoneNumbers) {
+                texts.append(FilterText { SeasideFilteredModel::PhoneNumbersRole, detail.number(), false });
+                continue;
+            }
+
+            // For phone numbers, match on the normalized from (punctuation stripped)
+            const QString normalized(QtContactsSqliteExtensions::normalizePhoneNumber(detail.number(), normalizeFlags));
+            if (!normalized.isEmpty()) {
+                texts.append(FilterText { SeasideFilteredModel::PhoneNumbersRole, normalized, false });
+            }
         }
 
+        return texts;
+    }
+
+    // Returns the tokens of text, without interning them; safe to call from any thread
+    static QStringList textTokens(const FilterText &text, const ML10N::MLocale &locale)
+    {
+        if (text.splitWords)
+            return splitWordTokens(text.text, locale);
+        return tokenize(locale.toLower(text.text), locale);
+    }
+
+    bool prepareFilter(SeasideCache::CacheItem *item)
+    {
         if (wildMatchKeys.isEmpty()) {
-            QList<const QString *> matchTokens;
-            matchTokens.reserve(100);
-
-            // initialise presenceMatchKeys for this contact
-            for (const QContactOnlineAccount &detail : item->contact.details<QContactOnlineAccount>())
-                insert(matchTokens, splitWords(stringPreceding(detail.accountUri(), atSymbol)));
-            for (const QContactGlobalPresence &detail : item->contact.details<QContactGlobalPresence>())
-                insert(matchTokens, splitWords(detail.nickname()));
-            for (const QContactPresence &detail : item->contact.details<QContactPresence>())
-                insert(matchTokens, splitWords(detail.nickname()));
-            presenceMatchKeys = toSortedVector(matchTokens);
-
-            // initialise the wildMatchKeys for this contact
-            const QVector<FieldMatchOperationSortPriority> &priorities(sortPriorities(sortLastNameFirst));
-            for (const FieldMatchOperationSortPriority &sortPriority : priorities) {
-                if (!wildMatchKeys.contains(sortPriority.field)) {
-                    wildMatchKeys.insert(sortPriority.field, QVector<QVector<const QString *> >());
-                }
-            }
+            const QVector<FilterText> texts(filterTexts(item));
 
-            // populate the wildMatchKeys for this contact
-            QContactName name = item->contact.detail<QContactName>();
+            QVector<QList<const QString *> > tokens;
+            tokens.reserve(texts.count());
+            for (const FilterText &text : texts)
+                tokens.append(text.splitWords ? splitWords(text.text) : makeSearchToken(text.text));
 
-            matchTokens = splitWords(sortByLastNameFirst ? name.lastName() : name.firstName());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[sortByLastNameFirst
-                            ? SeasideFilteredModel::LastNameRole
-                            : SeasideFilteredModel::FirstNameRole].append(matchTokens.toVector());
-            }
+            setKeys(texts, tokens);
+            return true;
+        }
 
-            matchTokens = splitWords(sortByLastNameFirst ? name.firstName() : name.lastName());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[sortByLastNameFirst
-                            ? SeasideFilteredModel::FirstNameRole
-                            : SeasideFilteredModel::LastNameRole].append(matchTokens.toVector());
-            }
+        return false;
+    }
 
-            matchTokens = splitWords(name.firstName());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            }
-            matchTokens = splitWords(name.middleName());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            }
-            matchTokens = splitWords(name.lastName());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            }
-            matchTokens = splitWords(name.prefix());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            }
-            matchTokens = splitWords(name.suffix());
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            };
-            matchTokens = splitWords(name.value<QString>(QContactName::FieldCustomLabel));
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            }
-            matchTokens = splitWords(item->displayLabel);
-            if (!matchTokens.isEmpty()) {
-                wildMatchKeys[SeasideFilteredModel::NameDetailsRole].append(matchTokens.toVector());
-            }
+    // Prepares the filter from texts that have already been tokenized
+    bool prepareFilter(const QVector<FilterText> &texts, const QVector<QStringList> &tokenStrings)
+    {
+        if (wildMatchKeys.isEmpty()) {
+            SearchTokenPool *pool = SearchTokenPool::instance();
 
-            for (const QContactNickname &detail : item->contact.details<QContactNickname>()) {
-                matchTokens = splitWords(detail.nickname());
-                if (matchTokens.size()) {
-                    wildMatchKeys[SeasideFilteredModel::NicknameDetailsRole].append(matchTokens.toVector());
-                }
-            }
-            for (const QContactEmailAddress &detail : item->contact.details<QContactEmailAddress>()) {
-                matchTokens = splitWords(detail.emailAddress());
-                if (!matchTokens.isEmpty()) {
-                    wildMatchKeys[SeasideFilteredModel::EmailAddressesRole].append(matchTokens.toVector());
-                }
-            }
-            for (const QContactOrganization &detail : item->contact.details<QContactOrganization>()) {
-                matchTokens = splitWords(detail.name());
-                if (!matchTokens.isEmpty()) {
-                    wildMatchKeys[SeasideFilteredModel::CompanyNameRole].append(matchTokens.toVector());
-                }
-            }
-            for (const QContactPhoneNumber &detail : item->contact.details<QContactPhoneNumber>()) {
-                // For phone numbers, match on the normalized from (punctuation stripped)
-                const QString normalized(QtContactsSqliteExtensions::normalizePhoneNumber(detail.number(), normalizeFlags));
-                if (!normalized.isEmpty()) {
-                    matchTokens = makeSearchToken(normalized);
-                    if (!matchTokens.isEmpty()) {
-                        wildMatchKeys[SeasideFilteredModel::PhoneNumbersRole].append(matchTokens.toVector());
-                    }
-                }
-            }
+            QVector<QList<const QString *> > tokens;
+            tokens.reserve(tokenStrings.count());
+            for (const QStringList &strings : tokenStrings)
+                tokens.append(pool->acquire(strings));
 
+            setKeys(texts, tokens);
             return true;
         }
 
         return false;
     }
 
+    // Takes ownership of the acquired tokens of each text
+    void setKeys(const QVector<FilterText> &texts, const QVector<QList<const QString *> > &tokens)
+    {
+        const QVector<FieldMatchOperationSortPriority> &priorities(sortPriorities());
+        for (const FieldMatchOperationSortPriority &sortPriority : priorities) {
+            if (!wildMatchKeys.contains(sortPriority.field)) {
+                wildMatchKeys.insert(sortPriority.field, QVector<QVector<const QString *> >());
+            }
+        }
+
+        QList<const QString *> presenceTokens;
+        for (int i = 0; i < texts.count(); ++i) {
+            const QList<const QString *> matchTokens(retain(tokens.at(i)));
+            if (texts.at(i).field == PresenceField) {
+                insert(presenceTokens, matchTokens);
+            } else if (!matchTokens.isEmpty()) {
+                wildMatchKeys[static_cast<SeasideFilteredModel::PeopleRoles>(texts.at(i).field)].append(matchTokens.toVector());
+            }
+        }
+        presenceMatchKeys = toSortedVector(presenceTokens);
+
+        // The first and last names, and the display label formed from them, are also name
+        // details; as the name fields are matched first, keep only the other name tokens here
+        QSet<const QString *> nameTokens;
+        for (SeasideFilteredModel::PeopleRoles field : { SeasideFilteredModel::FirstNameRole, SeasideFilteredModel::LastNameRole }) {
+            for (const QVector<const QString *> &tokens : wildMatchKeys.value(field)) {
+                for (const QString *token : tokens)
+                    nameTokens.insert(token);
+            }
+        }
+
+        QVector<QVector<const QString *> > &nameDetails(wildMatchKeys[SeasideFilteredModel::NameDetailsRole]);
+        for (QVector<QVector<const QString *> >::iterator it = nameDetails.begin(); it != nameDetails.end(); ) {
+            it->erase(std::remove_if(it->begin(), it->end(), [&nameTokens](const QString *token) {
+                return nameTokens.contains(token);
+            }), it->end());
+            it = it->isEmpty() ? nameDetails.erase(it) : it + 1;
+        }
+    }
+
     static const QChar *cbegin(const QString &s) { return s.cbegin(); }
     static const QChar *cend(const QString &s) { return s.cend(); }
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -512,9 +1094,9 @@ struct FilterData : public SeasideCache::ItemListener
 
             // Preceding base chars match - are there any continuing diacritics?
             QString::const_iterator vmatch = vit++, kmatch = kit++;
-            while (vit != vend && (*vit).category() == QChar::Mark_NonSpacing)
+            while (vit != vend && isNonSpacingMark(*vit))
                  ++vit;
-            while (kit != kend && (*kit).category() == QChar::Mark_NonSpacing)
+            while (kit != kend && isNonSpacingMark(*kit))
                  ++kit;
 
             if ((vit - vmatch) > 1) {
@@ -536,89 +1118,664 @@ struct FilterData : public SeasideCache::ItemListener
         return false;
     }
 
-    static bool partialMatchStartsWith(const QVector<QVector<const QString *> > &wildMatchTokens,
-                                       const QString &value)
+    // The part of a field of a contact matching a search term
+    struct MatchRange {
+        int field;
+        int detailIndex;    // The index of the matching value, for fields with several values
+        int start;
+        int length;
+    };
+
+    // Locates each of the terms within the stored text of the item, trying the fields in order
+    // of match priority, and any alternative spellings of the term within each field. Terms
+    // matching only presence details, or only fuzzy matching, are not located.
+    static QVector<MatchRange> matchRanges(SeasideCache::CacheItem *item, const QList<QStringList> &terms,
+                                           bool sortLastNameFirst, bool dialPad)
     {
-        const QChar *vbegin = value.cbegin(), *vend = value.cend();
-        for (const QVector<const QString *> &tokens : wildMatchTokens) {
-            if (tokens.size()) {
-                const QString &token(*tokens.first());
-                const QChar initialChar(*vbegin);
-                if (token.startsWith(initialChar) && partialMatch(token, vbegin, vend)) {
-                    return true;
+        const QVector<FilterText> texts(filterTexts(item, false));
+        QVector<QString> foldedTexts(texts.count());
+        QVector<QVector<int> > positions(texts.count());
+        QVector<int> detailIndices(texts.count());
+        QHash<int, int> fieldCounts;
+        for (int i = 0; i < texts.count(); ++i) {
+            const FilterText &text(texts.at(i));
+            if (text.field == PresenceField)
+                continue;
+
+            detailIndices[i] = fieldCounts[text.field]++;
+            foldedTexts[i] = matchFolded(text.text, dialPad, text.field == SeasideFilteredModel::PhoneNumbersRole,
+                                         &positions[i]);
+        }
+
+        QVector<MatchRange> ranges;
+        for (const QStringList &term : terms) {
+            QStringList values;
+            for (const QString &alternative : term) {
+                const QString value(matchFolded(alternative, dialPad, false));
+                if (!value.isEmpty() && !values.contains(value))
+                    values.append(value);
+            }
+            if (values.isEmpty())
+                continue;
+
+            bool found = false;
+            for (const FieldMatchOperationSortPriority &priority : sortPriorities(sortLastNameFirst)) {
+                for (int i = 0; i < texts.count() && !found; ++i) {
+                    if (texts.at(i).field != priority.field)
+                        continue;
+
+                    const QString &folded(foldedTexts.at(i));
+                    for (const QString &value : values) {
+                        int index = -1;
+                        if (priority.matchOperation == StartsWith) {
+                            index = folded.startsWith(value) ? 0 : -1;
+                        } else if (priority.matchOperation == Contains) {
+                            index = folded.indexOf(value);
+                        }
+                        if (index == -1)
+                            continue;
+
+                        // Include any diacritics of the last matching character
+                        const QString &text(texts.at(i).text);
+                        const int start = positions.at(i).at(index);
+                        int end = positions.at(i).at(index + value.size() - 1) + 1;
+                        while (end < text.size() && isNonSpacingMark(text.at(end)))
+                            ++end;
+
+                        ranges.append(MatchRange { priority.field, detailIndices.at(i), start, end - start });
+                        found = true;
+                        break;
+                    }
                 }
+                if (found)
+                    break;
             }
         }
-        return false;
+        return ranges;
+    }
+
+    void itemUpdated(SeasideCache::CacheItem *item);
+    void itemAboutToBeRemoved(SeasideCache::CacheItem *item);
+
+    // The filter keys are rebuilt when the contact changes, so they don't require it to stay complete
+    bool isActive() const { return false; }
+};
+
+// Bound to const references, so a namespace scope definition is required before C++17
+constexpr int FilterData::FuzzyMatchPriority;
+
+// An inverted index of the search tokens of all contacts, shared by every model.
+// Each distinct token is indexed once, with the fields of the contacts containing it.
+// Tokens of fields matched by 'contains' are also indexed by their other suffixes, so
+// that both 'starts with' and 'contains' matches are found with a prefix lookup. The
+// index is owned by the cache, and is discarded when the cache expires.
+class SearchIndex : public QObject
+{
+public:
+    static SearchIndex *instance()
+    {
+        static QPointer<SearchIndex> index;
+        if (!index) {
+            index = new SearchIndex(SeasideCache::instance());
+        }
+        return index;
     }
 
-    static bool partialMatchContains(const QVector<QVector<const QString *> > &wildMatchTokens,
-                                     const QString &value)
+    // Returns true if the item's tokens were added to the index
+    bool addItem(SeasideCache::CacheItem *item)
     {
-        const QChar *vbegin = value.cbegin(), *vend = value.cend();
-        for (const QVector<const QString *> &tokens : wildMatchTokens) {
-            for (QVector<const QString *>::const_iterator it = tokens.cbegin(), end = tokens.cend(); it != end; ++it) {
-                const QString &token(*(*it));
-                // Try to match the value anywhere inside the key
-                const QChar initialChar(*vbegin);
-                int index = -1;
-                while ((index = token.indexOf(initialChar, index + 1)) != -1) {
+        FilterData *filterData = FilterData::getItemFilterData(item);
+        if (filterData->indexed)
+            return false;
+
+        filterData->indexed = true;
+        if (m_indexed.contains(item->iid)) {
+            // This item has replaced an instance that was previously indexed
+            m_stale.insert(item->iid);
+        } else {
+            m_indexed.insert(item->iid);
+            addOccurrences(item);
+        }
+        return true;
+    }
+
+    // Adds each of the items to the index, returning the number added; when many items
+    // must be tokenized, the tokenization is distributed over the available cores
+    int addItems(const QList<SeasideCache::CacheItem *> &items)
+    {
+        QList<SeasideCache::CacheItem *> unprepared;
+        for (SeasideCache::CacheItem *item : items) {
+            const FilterData *filterData = FilterData::getItemFilterData(item);
+            if (!filterData->indexed && filterData->wildMatchKeys.isEmpty())
+                unprepared.append(item);
+        }
+        prepareItems(unprepared);
+
+        int count = 0;
+        for (SeasideCache::CacheItem *item : items) {
+            if (addItem(item))
+                ++count;
+        }
+        return count;
+    }
+
+    static bool isIndexed(SeasideCache::CacheItem *item) { return FilterData::getItemFilterData(item)->indexed; }
+
+    void itemUpdated(quint32 iid) { m_stale.insert(iid); }
+    void itemRemoved(quint32 iid)
+    {
+        m_stale.insert(iid);
+        m_indexed.remove(iid);
+    }
+
+    enum KeyType {
+        TextKeys = 0,
+        DialPadKeys
+    };
+
+    // Returns the best match priority of each contact matching all of the terms,
+    // considering only the contacts in restriction, if supplied. If fuzzy, terms not
+    // matched exactly may match names within a few edits, until the time budget is spent.
+    // If scores is supplied, it receives the sum of the best match score for each term.
+    QHash<quint32, int> search(const QList<QStringList> &terms, bool sortLastNameFirst,
+                               const QSet<quint32> *restriction = nullptr, KeyType keyType = TextKeys,
+                               bool fuzzy = false, QHash<quint32, int> *scores = nullptr)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        refresh();
+        if (keyType == DialPadKeys && !m_dialPadIndexed) {
+            // The dial pad keys are only indexed once they are first searched
+            m_dialPadSuffixes = m_suffixes;
+            std::sort(m_dialPadSuffixes.begin(), m_dialPadSuffixes.end(), LessThan<SearchTokenPool::dialPadKey>(m_tokens));
+            m_dialPadIndexed = true;
+        }
+
+        QHash<quint32, int> matches;
+        QHash<quint32, int> matchScores;
+        for (int i = 0; i < terms.count(); ++i) {
+            const QHash<quint32, int> *candidates = i > 0 ? &matches : nullptr;
+
+            QHash<quint32, int> termMatches;
+            QHash<quint32, int> termScores;
+            for (const QString &alternative : terms.at(i)) {
+                // A contact matching an earlier alternative takes the priority of that match
+                QHash<quint32, int> alternativeMatches;
+
+                const QString value(keyType == DialPadKeys ? alternative : stripMarks(alternative));
+                if (value.isEmpty())
+                    continue;
+                const bool valueHasMarks = value.size() != alternative.size();
+
+                const std::pair<SuffixIterator, SuffixIterator> range = keyType == DialPadKeys
+                        ? std::equal_range(m_dialPadSuffixes.cbegin(), m_dialPadSuffixes.cend(), value,
+                                           PrefixLessThan<SearchTokenPool::dialPadKey>(m_tokens))
+                        : std::equal_range(m_suffixes.cbegin(), m_suffixes.cend(), value,
+                                           PrefixLessThan<SearchTokenPool::folded>(m_tokens));
+                for (SuffixIterator it = range.first; it != range.second; ++it) {
+                    const Suffix &suffix(*it);
+                    const IndexedToken &indexed(m_tokens.at(suffix.token));
+
+                    // The prefix lookup ignores diacritics; unless neither the key nor the
+                    // value has any, test the exact match. Dial pad keys are always exact.
+                    const bool exact = keyType == DialPadKeys
+                            || (!valueHasMarks && !SearchTokenPool::hasMarks(indexed.token));
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-                    if (partialMatch(QStringView(token).mid(index), vbegin, vend)) {
+                    if (!exact && !FilterData::partialMatch(QStringView(*indexed.token).mid(suffix.offset),
+                                                            alternative.cbegin(), alternative.cend()))
 #else
-                    if (partialMatch(token.midRef(index), vbegin, vend)) {
+                    if (!exact && !FilterData::partialMatch(indexed.token->midRef(suffix.offset),
+                                                            alternative.cbegin(), alternative.cend()))
 #endif
-                        return true;
+                        continue;
+
+                    for (const Occurrence &occurrence : indexed.occurrences) {
+                        if ((candidates && !candidates->contains(occurrence.iid))
+                                || (restriction && !restriction->contains(occurrence.iid))
+                                || termMatches.contains(occurrence.iid))
+                            continue;
+
+                        // Not every field is matched from its start
+                        const int priority = matchPriority(occurrence, suffix.offset, sortLastNameFirst);
+                        if (priority < 0)
+                            continue;
+
+                        QHash<quint32, int>::iterator mit = alternativeMatches.find(occurrence.iid);
+                        if (mit == alternativeMatches.end()) {
+                            alternativeMatches.insert(occurrence.iid, priority);
+                        } else if (priority < *mit) {
+                            *mit = priority;
+                        }
+
+                        if (scores) {
+                            const int score = matchScore(priority, occurrence, suffix.offset);
+                            QHash<quint32, int>::iterator sit = termScores.find(occurrence.iid);
+                            if (sit == termScores.end()) {
+                                termScores.insert(occurrence.iid, score);
+                            } else if (score > *sit) {
+                                *sit = score;
+                            }
+                        }
                     }
                 }
+
+                for (QHash<quint32, int>::const_iterator mit = alternativeMatches.cbegin(); mit != alternativeMatches.cend(); ++mit)
+                    termMatches.insert(mit.key(), mit.value());
+            }
+
+            if (fuzzy && keyType == TextKeys && !terms.at(i).isEmpty()) {
+                const QString value(stripMarks(terms.at(i).first()));
+                const int maxDistance = fuzzyMatchDistance(value.size());
+                if (maxDistance > 0) {
+                    QSet<quint32> fuzzyMatches;
+                    fuzzySearch(value, maxDistance, timer, &fuzzyMatches);
+                    for (quint32 iid : fuzzyMatches) {
+                        if ((candidates && !candidates->contains(iid))
+                                || (restriction && !restriction->contains(iid))
+                                || termMatches.contains(iid))
+                            continue;
+                        termMatches.insert(iid, FilterData::FuzzyMatchPriority);
+                        if (scores)
+                            termScores.insert(iid, matchScore(FilterData::FuzzyMatchPriority));
+                    }
+                }
+            }
+
+            if (candidates) {
+                // Only contacts matching every term are retained, with their best priority
+                for (QHash<quint32, int>::iterator mit = termMatches.begin(); mit != termMatches.end(); ++mit)
+                    *mit = qMin(*mit, matches.value(mit.key()));
+                for (QHash<quint32, int>::iterator sit = termScores.begin(); sit != termScores.end(); ++sit)
+                    *sit += matchScores.value(sit.key());
+            }
+            matches = termMatches;
+            matchScores = termScores;
+            if (matches.isEmpty())
+                break;
+        }
+
+        if (scores)
+            *scores = matchScores;
+        return matches;
+    }
+
+private:
+    static const int PresenceField = FilterData::PresenceField;
+
+    // A field of a contact containing a token
+    struct Occurrence {
+        quint32 iid;
+        qint16 field;
+        quint8 position;    // The index of the token within the field value
+    };
+
+    // A distinct token, and the fields containing it
+    struct IndexedToken {
+        const QString *token;   // Null if this entry is unused
+        QVector<Occurrence> occurrences;
+        bool suffixesIndexed;
+    };
+
+    // A suffix of an indexed token; suffixes are ordered by their keys
+    struct Suffix {
+        quint32 token;          // The index of the token in m_tokens
+        quint16 offset;
+        quint16 foldedOffset;
+    };
+    typedef QVector<Suffix>::const_iterator SuffixIterator;
+
+    // The time in milliseconds that fuzzy matching may add to each search
+    static const int fuzzySearchBudget = 10;
+
+    typedef const QString &(*KeyFunction)(const QString *);
+
+    // Orders suffixes by their keys: either folded keys, which disregard any diacritics,
+    // or dial pad keys, which correspond one to one with the folded keys. Sorting and
+    // merging the suffixes is most of the cost of indexing, so the keys are compared with
+    // the vector unit where there is one.
+    template<KeyFunction key>
+    struct LessThan {
+        explicit LessThan(const QVector<IndexedToken> &tokens) : tokens(tokens) {}
+
+        bool operator()(const Suffix &lhs, const Suffix &rhs) const
+        {
+            const QString &lkey(key(tokens.at(lhs.token).token));
+            const QString &rkey(key(tokens.at(rhs.token).token));
+            return SeasideSubstringSearch::compare(lkey.constData() + lhs.foldedOffset, lkey.size() - lhs.foldedOffset,
+                                                   rkey.constData() + rhs.foldedOffset, rkey.size() - rhs.foldedOffset) < 0;
+        }
+
+        const QVector<IndexedToken> &tokens;
+    };
+
+    // Compares the key of a suffix to a value, if the key is truncated to the value's length
+    template<KeyFunction key>
+    struct PrefixLessThan {
+        explicit PrefixLessThan(const QVector<IndexedToken> &tokens) : tokens(tokens) {}
+
+        int compare(const Suffix &suffix, const QString &value) const
+        {
+            const QString &suffixKey(key(tokens.at(suffix.token).token));
+            const int length = qMin(suffixKey.size() - suffix.foldedOffset, value.size());
+            return SeasideSubstringSearch::compare(suffixKey.constData() + suffix.foldedOffset, length,
+                                                   value.constData(), value.size());
+        }
+
+        bool operator()(const Suffix &suffix, const QString &value) const { return compare(suffix, value) < 0; }
+        bool operator()(const QString &value, const Suffix &suffix) const { return compare(suffix, value) > 0; }
+
+        const QVector<IndexedToken> &tokens;
+    };
+
+    explicit SearchIndex(QObject *parent) : QObject(parent), m_dialPadIndexed(false) {}
+
+    ~SearchIndex()
+    {
+        for (const IndexedToken &indexed : m_tokens) {
+            if (indexed.token)
+                SearchTokenPool::release(QList<const QString *>() << indexed.token);
+        }
+    }
+
+    struct TokenizeJob {
+        SeasideCache::CacheItem *item;
+        QVector<FilterData::FilterText> texts;
+        QVector<QStringList> tokens;
+    };
+
+    struct JobRange {
+        int begin;
+        int end;
+    };
+
+    // Prepares the filter keys of the items, tokenizing ranges of them concurrently
+    static void prepareItems(const QList<SeasideCache::CacheItem *> &items)
+    {
+        // Below this size per thread, distributing the work costs more than it saves
+        const int minRangeSize = 250;
+
+        const int rangeCount = qMin(QThread::idealThreadCount(), items.count() / minRangeSize);
+        if (rangeCount <= 1)
+            return;
+
+        // Extract the text of each contact here, so that the workers do not share the cache items
+        QVector<TokenizeJob> jobs;
+        jobs.reserve(items.count());
+        for (SeasideCache::CacheItem *item : items)
+            jobs.append(TokenizeJob { item, FilterData::filterTexts(item), QVector<QStringList>() });
+
+        QVector<JobRange> ranges;
+        for (int i = 0; i < rangeCount; ++i) {
+            const JobRange range = { jobs.count() * i / rangeCount, jobs.count() * (i + 1) / rangeCount };
+            ranges.append(range);
+        }
+
+        const QVector<TokenizeJob>::iterator base = jobs.begin();
+        QtConcurrent::blockingMap(ranges, [base](const JobRange &range) {
+            // A locale cannot be shared between threads
+            const ML10N::MLocale locale(mLocale);
+            for (QVector<TokenizeJob>::iterator it = base + range.begin; it != base + range.end; ++it) {
+                it->tokens.reserve(it->texts.count());
+                for (const FilterData::FilterText &text : it->texts)
+                    it->tokens.append(FilterData::textTokens(text, locale));
             }
+        });
+
+        // Intern the tokens in the order of the items
+        for (const TokenizeJob &job : jobs)
+            FilterData::getItemFilterData(job.item)->prepareFilter(job.texts, job.tokens);
+    }
+
+    // Returns true if any match of this field may start within a token
+    static bool isContainsField(int field)
+    {
+        for (const FilterData::FieldMatchOperationSortPriority &priority : FilterData::sortPriorities()) {
+            if (priority.field == field && priority.matchOperation == FilterData::Contains)
+                return true;
         }
         return false;
     }
 
-    static bool partialMatch(SeasideFilteredModel::PeopleRoles field,
-                             MatchOperation op,
-                             const QHash<SeasideFilteredModel::PeopleRoles, QVector<QVector<const QString *> > > &wildMatchTokens,
-                             const QString &value)
+    // Returns the best priority of a match at offset within the token of this occurrence
+    static int matchPriority(const Occurrence &occurrence, int offset, bool sortLastNameFirst)
+    {
+        if (occurrence.field == PresenceField)
+            return offset == 0 ? 0 : -1; // presence field matches are sorted before other matches.
+
+        // Only the leading token of a field can match from the start of the field
+        const bool startsWith = offset == 0 && occurrence.position == 0;
+        for (const FilterData::FieldMatchOperationSortPriority &priority : FilterData::sortPriorities(sortLastNameFirst)) {
+            if (priority.field == occurrence.field
+                    && (priority.matchOperation == FilterData::Contains
+                        || (startsWith && priority.matchOperation == FilterData::StartsWith)))
+                return priority.sortPriority;
+        }
+        return -1;
+    }
+
+    static int matchScore(int priority)
+    {
+        return (FilterData::sortPriorities(false).size() - priority) * priorityScore;
+    }
+
+    // Returns the score of a match, from its priority and how near the start of the field it is
+    static int matchScore(int priority, const Occurrence &occurrence, int offset)
+    {
+        const int positionPenalty = qMin<int>(occurrence.position, 8) * 8 + qMin(offset, 8) * 4;
+        return matchScore(priority) - positionPenalty;
+    }
+
+    void appendSuffix(int token, int offset, int foldedOffset)
+    {
+        const Suffix suffix = { static_cast<quint32>(token), static_cast<quint16>(offset), static_cast<quint16>(foldedOffset) };
+        m_pending.append(suffix);
+    }
+
+    void addOccurrence(const QString *token, quint32 iid, int field, int position)
     {
-        if (op == StartsWith) {
-            return partialMatchStartsWith(wildMatchTokens.value(field), value);
+        int index;
+        QHash<const QString *, int>::const_iterator it = m_tokenIndices.constFind(token);
+        if (it != m_tokenIndices.cend()) {
+            index = *it;
         } else {
-            return partialMatchContains(wildMatchTokens.value(field), value);
+            // Keep the token while it is indexed, so that the index can't refer to another
+            // token later interned at the same address
+            SearchTokenPool::instance()->retain(token);
+
+            const IndexedToken indexed = { token, QVector<Occurrence>(), false };
+            if (m_freeTokens.isEmpty()) {
+                index = m_tokens.count();
+                m_tokens.append(indexed);
+            } else {
+                index = m_freeTokens.takeLast();
+                m_tokens[index] = indexed;
+            }
+            m_tokenIndices.insert(token, index);
+            appendSuffix(index, 0, 0);
+        }
+
+        IndexedToken &indexed(m_tokens[index]);
+        if (!indexed.suffixesIndexed && isContainsField(field)) {
+            indexed.suffixesIndexed = true;
+
+            int foldedOffset = 0;
+            for (int offset = 0; offset < token->size() && offset <= std::numeric_limits<quint16>::max(); ++offset) {
+                if (!isNonSpacingMark(token->at(offset))) {
+                    if (offset > 0)
+                        appendSuffix(index, offset, foldedOffset);
+                    ++foldedOffset;
+                }
+            }
         }
+
+        const Occurrence occurrence = { iid, static_cast<qint16>(field), static_cast<quint8>(qMin(position, 255)) };
+        indexed.occurrences.append(occurrence);
     }
 
-    int partialMatch(const QString &value) const
+    void addOccurrences(SeasideCache::CacheItem *item)
     {
-        const QChar *vbegin = value.cbegin(), *vend = value.cend();
-
-        // Find which subset of presence-match keys the value might match
-        typedef QVector<const QString *>::const_iterator VectorIterator;
-        std::pair<VectorIterator, VectorIterator> bounds = std::equal_range(presenceMatchKeys.cbegin(),
-                                                                            presenceMatchKeys.cend(), vbegin,
-                                                                            FirstElementLessThanIndirect());
-        for ( ; bounds.first != bounds.second; ++bounds.first) {
-            const QString &key(*(*bounds.first));
-            if (partialMatch(key, vbegin, vend)) {
-                return 0; // presence field matches are sorted before other matches.
+        FilterData *filterData = FilterData::getItemFilterData(item);
+        filterData->prepareFilter(item);
+
+        for (const QString *token : filterData->presenceMatchKeys)
+            addOccurrence(token, item->iid, PresenceField, 0);
+
+        QHash<SeasideFilteredModel::PeopleRoles, QVector<QVector<const QString *> > >::const_iterator it = filterData->wildMatchKeys.cbegin();
+        for ( ; it != filterData->wildMatchKeys.cend(); ++it) {
+            for (const QVector<const QString *> &tokens : it.value()) {
+                for (int position = 0; position < tokens.count(); ++position)
+                    addOccurrence(tokens.at(position), item->iid, it.key(), position);
             }
         }
+    }
 
-        // Test to see if there is a match in any of the search-match fields
-        const QVector<FieldMatchOperationSortPriority> &priorities(sortPriorities(sortLastNameFirst));
-        for (const FieldMatchOperationSortPriority &priority : priorities) {
-            if (partialMatch(priority.field, priority.matchOperation, wildMatchKeys, value)) {
-                return priority.sortPriority;
+    void refresh()
+    {
+        if (!m_stale.isEmpty()) {
+            // Remove the occurrences of any updated or removed contacts, and re-index those remaining
+            const QSet<quint32> stale(m_stale);
+            m_stale.clear();
+
+            QSet<quint32> removedTokens;
+            for (int index = 0; index < m_tokens.count(); ++index) {
+                IndexedToken &indexed(m_tokens[index]);
+                if (!indexed.token)
+                    continue;
+
+                indexed.occurrences.erase(std::remove_if(indexed.occurrences.begin(), indexed.occurrences.end(),
+                                                         [&stale](const Occurrence &occurrence) { return stale.contains(occurrence.iid); }),
+                                          indexed.occurrences.end());
+                if (indexed.occurrences.isEmpty()) {
+                    // No contact has this token any longer
+                    m_tokenIndices.remove(indexed.token);
+                    SearchTokenPool::release(QList<const QString *>() << indexed.token);
+                    indexed = IndexedToken { nullptr, QVector<Occurrence>(), false };
+                    m_freeTokens.append(index);
+                    removedTokens.insert(index);
+                }
+            }
+
+            if (!removedTokens.isEmpty()) {
+                const auto isRemoved = [&removedTokens](const Suffix &suffix) { return removedTokens.contains(suffix.token); };
+                m_suffixes.erase(std::remove_if(m_suffixes.begin(), m_suffixes.end(), isRemoved), m_suffixes.end());
+                m_dialPadSuffixes.erase(std::remove_if(m_dialPadSuffixes.begin(), m_dialPadSuffixes.end(), isRemoved), m_dialPadSuffixes.end());
+                m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), isRemoved), m_pending.end());
+            }
+
+            for (quint32 iid : stale) {
+                if (m_indexed.contains(iid)) {
+                    if (SeasideCache::CacheItem *item = SeasideCache::existingItem(iid)) {
+                        addOccurrences(item);
+                    } else {
+                        m_indexed.remove(iid);
+                    }
+                }
             }
         }
 
-        return -1;
+        if (!m_pending.isEmpty()) {
+            if (m_dialPadIndexed)
+                merge(m_dialPadSuffixes, m_pending, LessThan<SearchTokenPool::dialPadKey>(m_tokens));
+            merge(m_suffixes, m_pending, LessThan<SearchTokenPool::folded>(m_tokens));
+            m_pending.clear();
+        }
+    }
+
+    // Finds the contacts with a name token starting with a string within maxDistance edits
+    // of value. The sorted suffixes are walked as a trie, abandoning any prefix too distant
+    // from every prefix of value, and stopping once the time budget is spent.
+    void fuzzySearch(const QString &value, int maxDistance, const QElapsedTimer &timer, QSet<quint32> *matches) const
+    {
+        fuzzySearch(m_suffixes.cbegin(), m_suffixes.cend(), 0, initialEditDistances(value),
+                    value, maxDistance, timer, matches);
+    }
+
+    bool fuzzySearch(SuffixIterator begin, SuffixIterator end, int depth, const QVector<int> &row,
+                     const QString &value, int maxDistance, const QElapsedTimer &timer,
+                     QSet<quint32> *matches) const
+    {
+        if (row.last() <= maxDistance) {
+            // This prefix of every key in the range is close enough to value
+            for (SuffixIterator it = begin; it != end; ++it) {
+                if (it->foldedOffset != 0)
+                    continue;
+                for (const Occurrence &occurrence : m_tokens.at(it->token).occurrences) {
+                    if (FilterData::isFuzzyMatchField(occurrence.field))
+                        matches->insert(occurrence.iid);
+                }
+            }
+            return true;
+        }
+        if (*std::min_element(row.cbegin(), row.cend()) > maxDistance)
+            return true;
+        if (timer.hasExpired(fuzzySearchBudget))
+            return false;
+
+        // Keys ending at this depth are ordered before any longer keys sharing their prefix
+        const auto keyLength = [this](const Suffix &suffix) {
+            return SearchTokenPool::folded(m_tokens.at(suffix.token).token).size() - suffix.foldedOffset;
+        };
+        const auto keyAt = [this, depth](const Suffix &suffix) {
+            return SearchTokenPool::folded(m_tokens.at(suffix.token).token).at(suffix.foldedOffset + depth);
+        };
+
+        SuffixIterator it = begin;
+        while (it != end && keyLength(*it) == depth)
+            ++it;
+
+        QVector<int> nextRow(row.size());
+        while (it != end) {
+            const QChar c(keyAt(*it));
+            const SuffixIterator next = std::upper_bound(it, end, c, [&keyAt](const QChar &c, const Suffix &suffix) {
+                return c < keyAt(suffix);
+            });
+
+            advanceEditDistances(row, c, value, &nextRow);
+            if (!fuzzySearch(it, next, depth + 1, nextRow, value, maxDistance, timer, matches))
+                return false;
+            it = next;
+        }
+        return true;
     }
 
-    void itemUpdated(SeasideCache::CacheItem *) { presenceMatchKeys.clear(); wildMatchKeys.clear(); }
-    void itemAboutToBeRemoved(SeasideCache::CacheItem *) { delete this; }
+    template<typename LessThanType>
+    static void merge(QVector<Suffix> &suffixes, QVector<Suffix> pending, LessThanType lessThan)
+    {
+        std::sort(pending.begin(), pending.end(), lessThan);
+
+        const int count = suffixes.count();
+        suffixes += pending;
+        std::inplace_merge(suffixes.begin(), suffixes.begin() + count, suffixes.end(), lessThan);
+    }
+
+    QVector<IndexedToken> m_tokens;
+    QHash<const QString *, int> m_tokenIndices;
+    QVector<int> m_freeTokens;
+    QVector<Suffix> m_suffixes;
+    QVector<Suffix> m_dialPadSuffixes;
+    QVector<Suffix> m_pending;
+    QSet<quint32> m_indexed;
+    QSet<quint32> m_stale;
+    bool m_dialPadIndexed;
 };
 
+void FilterData::itemUpdated(SeasideCache::CacheItem *item)
+{
+    clear();
+
+    if (indexed)
+        SearchIndex::instance()->itemUpdated(item->iid);
+}
+
+void FilterData::itemAboutToBeRemoved(SeasideCache::CacheItem *item)
+{
+    if (indexed)
+        SearchIndex::instance()->itemRemoved(item->iid);
+
+    delete this;
+}
+
 /*!
   \qmltype PeopleModel
   \inqmlmodule org.nemomobile.contacts
@@ -629,22 +1786,37 @@ struct FilterData : public SeasideCache::ItemListener
 */
 SeasideFilteredModel::SeasideFilteredModel(QObject *parent)
     : SeasideCache::ListModel(parent)
-    , m_filterUpdateIndex(-1)
     , m_filterType(FilterAll)
     , m_effectiveFilterType(FilterAll)
     , m_requiredProperty(NoPropertyRequired)
     , m_searchableProperty(NoPropertySearchable)
     , m_searchByFirstNameCharacter(false)
     , m_savePersonActive(false)
+    , m_searchIndexed(false)
+    , m_searchMode(TextSearch)
+    , m_fuzzySearch(false)
+    , m_rankedSearch(false)
+    , m_asynchronousSearch(false)
+    , m_searching(false)
+    , m_searchScheduled(false)
+    , m_pendingSearch(NoSearch)
+    , m_searchGeneration(0)
+    , m_filterGeneration(0)
     , m_lastItem(0)
     , m_lastId(0)
 {
     updateRegistration();
 
-    m_allContactIds = SeasideCache::contacts(SeasideCache::FilterAll);
+    m_allContactIds = SeasideCache::contactIdList(SeasideCache::FilterAll);
     m_referenceContactIds = m_allContactIds;
-    m_contactIds = m_allContactIds;
+    m_usingFilteredIndex = false;
     updateSectionBucketIndexCache();
+
+    connect(SeasideSearchPrewarmer::instance(), &SeasideSearchPrewarmer::progressChanged,
+            this, &SeasideFilteredModel::searchIndexProgressChanged);
+    if (SeasideCache::isPopulated(SeasideCache::FilterAll)) {
+        prewarmSearchIndex();
+    }
 }
 
 SeasideFilteredModel::~SeasideFilteredModel()
@@ -682,6 +1854,7 @@ QHash<int, QByteArray> SeasideFilteredModel::roleNames() const
     roles.insert(NameDetailsRole, nameDetailsRole);
     roles.insert(FilterMatchDataRole, filterMatchDataRole);
     roles.insert(AddressBookRole, addressBookRole);
+    roles.insert(FilterMatchRangesRole, filterMatchRangesRole);
     return roles;
 }
 
@@ -766,13 +1939,14 @@ void SeasideFilteredModel::setFilterType(FilterType type)
             updateRegistration();
 
             if (!filtered) {
-                m_filteredContactIds = *m_referenceContactIds;
+                m_filteredContactIds = m_referenceContactIds->toList();
             }
 
-            m_referenceContactIds = SeasideCache::contacts(static_cast<SeasideCache::FilterType>(m_filterType));
+            m_referenceContactIds = SeasideCache::contactIdList(static_cast<SeasideCache::FilterType>(m_filterType));
+            m_searchIndexed = false;
             updateIndex();
             if (!filtered) {
-                m_contactIds = m_referenceContactIds;
+                m_usingFilteredIndex = false;
                 m_filteredContactIds.clear();
             }
 
@@ -794,56 +1968,246 @@ QString SeasideFilteredModel::filterPattern() const
     return m_filterPattern;
 }
 
-void SeasideFilteredModel::setFilterPattern(const QString &pattern)
+void SeasideFilteredModel::setFilterPattern(const QString &pattern)
+{
+    updateFilters(pattern, m_requiredProperty);
+}
+
+/*!
+  \qmlproperty int PeopleModel::requiredProperty
+*/
+int SeasideFilteredModel::requiredProperty() const
+{
+    return m_requiredProperty;
+}
+
+void SeasideFilteredModel::setRequiredProperty(int type)
+{
+    updateFilters(m_filterPattern, type);
+}
+
+/*!
+  \qmlproperty int PeopleModel::searchableProperty
+*/
+int SeasideFilteredModel::searchableProperty() const
+{
+    return m_searchableProperty;
+}
+
+void SeasideFilteredModel::setSearchableProperty(int type)
+{
+    if (m_searchableProperty != type) {
+        m_searchableProperty = type;
+
+        updateRegistration();
+        emit searchablePropertyChanged();
+    }
+}
+
+/*!
+  \qmlproperty bool PeopleModel::searchByFirstNameCharacter
+*/
+bool SeasideFilteredModel::searchByFirstNameCharacter() const
+{
+    return m_searchByFirstNameCharacter;
+}
+
+void SeasideFilteredModel::setSearchByFirstNameCharacter(bool searchByFirstNameCharacter)
+{
+    if (m_searchByFirstNameCharacter != searchByFirstNameCharacter) {
+        m_searchByFirstNameCharacter = searchByFirstNameCharacter;
+        emit searchByFirstNameCharacterChanged();
+    }
+}
+
+/*!
+  \qmlproperty enumeration PeopleModel::searchMode
+
+  Selects how the filterPattern is matched to contacts:
+
+  \value TextSearch
+         The words of the pattern are matched to the words of each contact's details.
+  \value T9Search
+         The pattern is a sequence of dial pad keys, matched to the keys of the letters
+         and digits in each contact's details. Any letters in the pattern are replaced by
+         their keys.
+
+  Defaults to TextSearch.
+*/
+SeasideFilteredModel::SearchMode SeasideFilteredModel::searchMode() const
+{
+    return m_searchMode;
+}
+
+void SeasideFilteredModel::setSearchMode(SearchMode mode)
+{
+    if (m_searchMode != mode) {
+        m_searchMode = mode;
+
+        if (!m_filterPattern.isEmpty()) {
+            updateFilterParts();
+
+            if (isFiltered()) {
+                const int prevCount = rowCount();
+
+                updateIndex();
+                populateSectionBucketIndices();
+
+                if (rowCount() != prevCount) {
+                    emit countChanged();
+                }
+            }
+        }
+
+        emit searchModeChanged();
+    }
+}
+
+/*!
+  \qmlproperty bool PeopleModel::fuzzySearch
+
+  If true, a word of the filterPattern that matches no contact exactly may match the
+  start of a name within one edit (two edits for words of eight or more characters).
+  Words shorter than four characters are only matched exactly. Fuzzy matches are
+  ordered after all exact matches, and fuzzy matching is limited to a fixed time for
+  each change to the filter. Only applies to TextSearch. Defaults to false.
+*/
+bool SeasideFilteredModel::fuzzySearch() const
+{
+    return m_fuzzySearch;
+}
+
+void SeasideFilteredModel::setFuzzySearch(bool fuzzySearch)
+{
+    if (m_fuzzySearch != fuzzySearch) {
+        m_fuzzySearch = fuzzySearch;
+
+        if (!m_filterPattern.isEmpty() && isFiltered()) {
+            const int prevCount = rowCount();
+
+            updateIndex();
+            populateSectionBucketIndices();
+
+            if (rowCount() != prevCount) {
+                emit countChanged();
+            }
+        }
+
+        emit fuzzySearchChanged();
+    }
+}
+
+bool SeasideFilteredModel::isFuzzy() const
 {
-    updateFilters(pattern, m_requiredProperty);
+    return m_fuzzySearch && m_searchMode == TextSearch && !m_searchByFirstNameCharacter;
 }
 
 /*!
-  \qmlproperty int PeopleModel::requiredProperty
+  \qmlproperty bool PeopleModel::rankedSearch
+
+  If true, the contacts matching the filterPattern are ordered by a score combining the
+  field and position of the match of each word, the favorite status of the contact, and
+  how often and how recently the contact has been used, as reported by recordContactUse().
+  Contacts with equal scores retain the order of the unfiltered list.
+
+  Contact use is recorded only for the lifetime of the process, and is shared by all models;
+  it is not persisted, so the usage component of the score is empty after every restart.
+
+  Only the leading results of a ranked search are ordered when the search is evaluated,
+  whether or not asynchronousSearch is set. The remaining results are appended in later
+  steps, in order, while searching is true.
+
+  If false, contacts are ordered by the best matching field only. Defaults to false.
 */
-int SeasideFilteredModel::requiredProperty() const
+bool SeasideFilteredModel::rankedSearch() const
 {
-    return m_requiredProperty;
+    return m_rankedSearch;
 }
 
-void SeasideFilteredModel::setRequiredProperty(int type)
+void SeasideFilteredModel::setRankedSearch(bool rankedSearch)
 {
-    updateFilters(m_filterPattern, type);
+    if (m_rankedSearch != rankedSearch) {
+        m_rankedSearch = rankedSearch;
+
+        if (!m_filterPattern.isEmpty() && isFiltered()) {
+            updateIndex();
+            populateSectionBucketIndices();
+        }
+
+        emit rankedSearchChanged();
+    }
 }
 
 /*!
-  \qmlproperty int PeopleModel::searchableProperty
+  \qmlproperty bool PeopleModel::asynchronousSearch
+
+  If true, changes to the filter are evaluated after control returns to the event loop,
+  so that a rapid sequence of changes is evaluated once. The leading results are published
+  first, and the remaining results are appended in later steps. Defaults to false.
 */
-int SeasideFilteredModel::searchableProperty() const
+bool SeasideFilteredModel::asynchronousSearch() const
 {
-    return m_searchableProperty;
+    return m_asynchronousSearch;
 }
 
-void SeasideFilteredModel::setSearchableProperty(int type)
+void SeasideFilteredModel::setAsynchronousSearch(bool asynchronousSearch)
 {
-    if (m_searchableProperty != type) {
-        m_searchableProperty = type;
+    if (m_asynchronousSearch != asynchronousSearch) {
+        m_asynchronousSearch = asynchronousSearch;
 
-        updateRegistration();
-        emit searchablePropertyChanged();
+        if (!m_asynchronousSearch && m_searching) {
+            // Complete the search in progress
+            const int prevCount = rowCount();
+            if (m_pendingSearch == RefineSearch && m_pendingContactIds.isEmpty()) {
+                m_pendingSearch = NoSearch;
+                refineIndex();
+                populateSectionBucketIndices();
+            } else {
+                populateIndex();
+            }
+            updateSearching();
+
+            if (rowCount() != prevCount) {
+                emit countChanged();
+            }
+        }
+
+        emit asynchronousSearchChanged();
     }
 }
 
 /*!
-  \qmlproperty bool PeopleModel::searchByFirstNameCharacter
+  \qmlproperty bool PeopleModel::searching
+
+  True while an asynchronous search has not yet published all of its results.
 */
-bool SeasideFilteredModel::searchByFirstNameCharacter() const
+bool SeasideFilteredModel::isSearching() const
 {
-    return m_searchByFirstNameCharacter;
+    return m_searching;
 }
 
-void SeasideFilteredModel::setSearchByFirstNameCharacter(bool searchByFirstNameCharacter)
+/*!
+  \qmlproperty int PeopleModel::searchGeneration
+
+  Incremented whenever an asynchronous search begins to publish its results.
+*/
+int SeasideFilteredModel::searchGeneration() const
 {
-    if (m_searchByFirstNameCharacter != searchByFirstNameCharacter) {
-        m_searchByFirstNameCharacter = searchByFirstNameCharacter;
-        emit searchByFirstNameCharacterChanged();
-    }
+    return m_searchGeneration;
+}
+
+/*!
+  \qmlproperty real PeopleModel::searchIndexProgress
+
+  The proportion of the contacts scheduled for preparation that have been prepared for
+  searching. Contacts are prepared while the application is idle once the model is
+  populated, leading rows and favorites first, and not while the display is off.
+  Searches made before preparation is complete prepare any remaining contacts first.
+  1 when no preparation is pending.
+*/
+qreal SeasideFilteredModel::searchIndexProgress() const
+{
+    return SeasideSearchPrewarmer::instance()->progress();
 }
 
 int SeasideFilteredModel::filterId(quint32 iid) const
@@ -855,59 +2219,226 @@ int SeasideFilteredModel::filterId(quint32 iid) const
         return MatchPriority;
 
     SeasideCache::CacheItem *item = existingItem(iid);
-    if (!item)
+    if (!item || !hasRequiredProperty(item))
         return NoMatchPriority;
 
-    if (m_requiredProperty != NoPropertyRequired) {
-        bool haveMatch = (m_requiredProperty & AccountUriRequired)
-                && (item->statusFlags & SeasideCache::HasValidOnlineAccount);
-        haveMatch |= (m_requiredProperty & PhoneNumberRequired)
-                && (item->statusFlags & QContactStatusFlags::HasPhoneNumber);
-        haveMatch |= (m_requiredProperty & EmailAddressRequired)
-                && (item->statusFlags & QContactStatusFlags::HasEmailAddress);
-        if (!haveMatch)
-            return NoMatchPriority;
-        if (m_filterParts.isEmpty())
-            return MatchPriority;
-    }
+    if (m_filterParts.isEmpty())
+        return MatchPriority;
 
     if (m_searchByFirstNameCharacter && !m_filterPattern.isEmpty())
         return m_filterPattern == SeasideCache::displayLabelGroup(item) ? MatchPriority : NoMatchPriority;
 
-    FilterData *filterData = FilterData::getItemFilterData(item, this);
-    filterData->prepareFilter(item, sortProperty());
-
-    // search forwards over the label components for each filter word, making
-    // sure to find all filter words before considering it a match.
-    int bestMatchPriority = NoMatchPriority;
-    for (const QStringList &part : m_filterParts) {
-        bool match = false;
-        for (const QString &alternative : part) {
-            const int matchPriority = filterData->partialMatch(alternative);
-            if (matchPriority >= MatchPriority) {
-                match = true;
-                if (bestMatchPriority == NoMatchPriority || bestMatchPriority > matchPriority) {
-                    bestMatchPriority = matchPriority;
-                }
-                break;
+    // Text is matched by the shared index, restricted to this contact, so that a single
+    // contact is matched exactly as it would be by a search of the whole list
+    SearchIndex *index = SearchIndex::instance();
+    index->addItem(item);
+
+    const bool sortLastNameFirst = sortProperty().compare(QStringLiteral("lastName"), Qt::CaseInsensitive) == 0;
+    const SearchIndex::KeyType keyType = m_searchMode == T9Search ? SearchIndex::DialPadKeys : SearchIndex::TextKeys;
+    QSet<quint32> restriction;
+    restriction.insert(iid);
+    const QHash<quint32, int> matches(index->search(m_filterParts, sortLastNameFirst, &restriction, keyType, isFuzzy()));
+
+    QHash<quint32, int>::const_iterator it = matches.constFind(iid);
+    if (it == matches.cend())
+        return NoMatchPriority;
+
+    item->filterMatchRole = FilterData::sortPriorities(sortLastNameFirst)[it.value()].field;
+    return it.value();
+}
+
+bool SeasideFilteredModel::hasRequiredProperty(SeasideCache::CacheItem *item) const
+{
+    if (m_requiredProperty == NoPropertyRequired)
+        return true;
+
+    bool haveMatch = (m_requiredProperty & AccountUriRequired)
+            && (item->statusFlags & SeasideCache::HasValidOnlineAccount);
+    haveMatch |= (m_requiredProperty & PhoneNumberRequired)
+            && (item->statusFlags & QContactStatusFlags::HasPhoneNumber);
+    haveMatch |= (m_requiredProperty & EmailAddressRequired)
+            && (item->statusFlags & QContactStatusFlags::HasEmailAddress);
+    return haveMatch;
+}
+
+// Returns the ranges of the item matching the filter, located once in each filter generation
+QVariantList SeasideFilteredModel::filterMatchRanges(SeasideCache::CacheItem *item) const
+{
+    QVariantList ranges;
+    if (m_filterParts.isEmpty() || m_searchByFirstNameCharacter)
+        return ranges;
+
+    QHash<quint32, QPair<int, QVariantList> >::const_iterator it = m_filterMatchRanges.constFind(item->iid);
+    if (it != m_filterMatchRanges.cend() && it->first == m_filterGeneration)
+        return it->second;
+
+    const bool sortLastNameFirst = sortProperty().compare(QStringLiteral("lastName"), Qt::CaseInsensitive) == 0;
+    for (const FilterData::MatchRange &range : FilterData::matchRanges(item, m_filterParts, sortLastNameFirst,
+                                                                      m_searchMode == T9Search)) {
+        QVariantMap map;
+        map.insert(QStringLiteral("field"), range.field);
+        map.insert(QStringLiteral("detailIndex"), range.detailIndex);
+        map.insert(QStringLiteral("start"), range.start);
+        map.insert(QStringLiteral("length"), range.length);
+        ranges.append(map);
+    }
+    m_filterMatchRanges.insert(item->iid, qMakePair(m_filterGeneration, ranges));
+    return ranges;
+}
+
+// Starts a new filter generation once the filter has been evaluated. Only the rows whose
+// ranges have been read can be stale in a view, so only those are located again, and
+// reported where they differ; the ranges of other rows are located when first read.
+void SeasideFilteredModel::updateFilterMatchRanges()
+{
+    ++m_filterGeneration;
+    if (m_filterMatchRanges.isEmpty())
+        return;
+
+    const QHash<quint32, QPair<int, QVariantList> > previousRanges(m_filterMatchRanges);
+    m_filterMatchRanges.clear();
+
+    static const QVector<int> changedRoles { FilterMatchRangesRole };
+    const int count = contactCount();
+    int changedBegin = -1;
+    for (int row = 0; row <= count; ++row) {
+        bool changed = false;
+        if (row < count) {
+            const quint32 iid = contactIdAt(row);
+            QHash<quint32, QPair<int, QVariantList> >::const_iterator it = previousRanges.constFind(iid);
+            if (it != previousRanges.cend()) {
+                SeasideCache::CacheItem *item = existingItem(iid);
+                changed = (item ? filterMatchRanges(item) : QVariantList()) != it->second;
             }
         }
-        if (!match) {
-            return NoMatchPriority;
+
+        if (changed && changedBegin == -1) {
+            changedBegin = row;
+        } else if (!changed && changedBegin != -1) {
+            emit dataChanged(createIndex(changedBegin, 0), createIndex(row - 1, 0), changedRoles);
+            changedBegin = -1;
         }
     }
-
-    item->filterMatchRole = FilterData::sortPriorities(filterData->sortLastNameFirst)[bestMatchPriority].field;
-    return bestMatchPriority;
 }
 
 void SeasideFilteredModel::refineIndex()
 {
-    // While the filtered list will be a guaranteed sub-set of the current list,
-    // unfortunately the order of individual elements may change entirely,
-    // so we cannot merely remove now-non-matching elements.
-    // TODO: only search the current m_filteredContactIds list when repopulating?
-    updateIndex();
+    // The refined filter matches a sub-set of the current list, so only those
+    // contacts need to be tested again.
+    if (!m_usingFilteredIndex
+            || !m_pendingContactIds.isEmpty()
+            || (m_filterParts.isEmpty() && m_requiredProperty == NoPropertyRequired)) {
+        updateIndex();
+        return;
+    }
+
+    const bool sortLastNameFirst = sortProperty().compare(QStringLiteral("lastName"), Qt::CaseInsensitive) == 0;
+    QHash<quint32, int> filteredPriorities;
+    QVector<QPair<qint64, quint32> > rankedMatches;
+    bool ranked = false;
+    if (!m_filterParts.isEmpty() && !m_searchByFirstNameCharacter) {
+        SearchIndex *index = SearchIndex::instance();
+        QSet<quint32> candidates;
+        QList<SeasideCache::CacheItem *> items;
+        candidates.reserve(m_filteredContactIds.count());
+        items.reserve(m_filteredContactIds.count());
+        for (int i = 0; i < m_filteredContactIds.count(); ++i) {
+            const quint32 iid = m_filteredContactIds.at(i);
+            if (SeasideCache::CacheItem *item = existingItem(iid)) {
+                items.append(item);
+                candidates.insert(iid);
+            }
+        }
+        index->addItems(items);
+
+        const SearchIndex::KeyType keyType = m_searchMode == T9Search ? SearchIndex::DialPadKeys : SearchIndex::TextKeys;
+        QHash<quint32, int> scores;
+        const QHash<quint32, int> matches(index->search(m_filterParts, sortLastNameFirst, &candidates, keyType, isFuzzy(),
+                                                        m_rankedSearch ? &scores : nullptr));
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        ranked = m_rankedSearch;
+        for (QHash<quint32, int>::const_iterator it = matches.cbegin(); it != matches.cend(); ++it) {
+            SeasideCache::CacheItem *item = existingItem(it.key());
+            if (!item || !hasRequiredProperty(item))
+                continue;
+
+            item->filterMatchRole = FilterData::sortPriorities(sortLastNameFirst)[it.value()].field;
+            filteredPriorities.insert(it.key(), it.value());
+            if (ranked) {
+                const int row = m_referenceContactIds->indexOf(it.key());
+                rankedMatches.append(qMakePair(rankKey(scores.value(it.key()) + contactScore(item, now), row), it.key()));
+            }
+        }
+    } else {
+        for (int i = 0; i < m_filteredContactIds.count(); ++i) {
+            const quint32 iid = m_filteredContactIds.at(i);
+            const int bestMatchPriority = filterId(iid);
+            if (bestMatchPriority >= 0)
+                filteredPriorities.insert(iid, bestMatchPriority);
+        }
+    }
+
+    QList<quint32> filteredContactIds;
+    bool prioritiesChanged = false;
+    if (ranked) {
+        // The scores of the remaining contacts may have changed relative to each other
+        for (QHash<quint32, int>::const_iterator it = filteredPriorities.cbegin(); it != filteredPriorities.cend(); ++it)
+            prioritiesChanged |= (it.value() != m_filteredPriorities.value(it.key(), -1));
+
+        filteredContactIds = rankedContactIds(&rankedMatches, initialResultCount);
+    } else {
+        // The current list is ordered by reference position within each match priority. Contacts
+        // moving into a priority together with contacts from another priority must be reordered,
+        // but a priority populated from a single previous priority is already in order.
+        QVector<QVector<quint32> > priorityBucketedContacts(FilterData::sortPriorities(sortLastNameFirst).size());
+        QVector<int> previousPriorities(priorityBucketedContacts.size(), -1);
+        QVector<bool> reorderRequired(priorityBucketedContacts.size(), false);
+        for (int i = 0; i < m_filteredContactIds.count(); ++i) {
+            const quint32 iid = m_filteredContactIds.at(i);
+            QHash<quint32, int>::const_iterator it = filteredPriorities.constFind(iid);
+            if (it == filteredPriorities.cend())
+                continue;
+
+            const int priority = it.value();
+            const int previousPriority = m_filteredPriorities.value(iid, -1);
+            prioritiesChanged |= (priority != previousPriority);
+
+            if (priorityBucketedContacts.at(priority).isEmpty()) {
+                previousPriorities[priority] = previousPriority;
+            } else if (previousPriorities.at(priority) != previousPriority) {
+                reorderRequired[priority] = true;
+            }
+            priorityBucketedContacts[priority].append(iid);
+        }
+
+        for (int i = 0; i < priorityBucketedContacts.count(); ++i) {
+            if (reorderRequired.at(i)) {
+                const SeasideContactIdList *referenceIds = m_referenceContactIds;
+                std::sort(priorityBucketedContacts[i].begin(), priorityBucketedContacts[i].end(),
+                          [referenceIds](quint32 lhs, quint32 rhs) {
+                    return referenceIds->indexOf(lhs) < referenceIds->indexOf(rhs);
+                });
+            }
+        }
+
+        filteredContactIds = sortedContactIds(priorityBucketedContacts);
+    }
+
+    // Only the leading results of a ranked search are ordered; the remainder are appended later
+    deferSearchResults(&filteredContactIds, rankedMatches, ranked ? initialResultCount : -1);
+
+    // Remove the contacts no longer matching, and move any whose priority has changed
+    synchronizeList(this, m_filteredContactIds, filteredContactIds);
+    m_filteredPriorities = filteredPriorities;
+    updateSearching();
+
+    if (prioritiesChanged && !m_filteredContactIds.isEmpty()) {
+        static const QVector<int> changedRoles { FilterMatchDataRole };
+        emit dataChanged(createIndex(0, 0), createIndex(m_filteredContactIds.count() - 1, 0), changedRoles);
+    }
+
+    // The matching ranges change with the filter, even where the match priority does not
+    updateFilterMatchRanges();
 }
 
 void SeasideFilteredModel::updateIndex()
@@ -915,9 +2446,10 @@ void SeasideFilteredModel::updateIndex()
     populateIndex();
 }
 
-void SeasideFilteredModel::populateIndex()
+void SeasideFilteredModel::populateIndex(int limit)
 {
     QList<quint32> filteredContactIds;
+    QHash<quint32, int> filteredPriorities;
 
     // Scan through the reference list searching for contacts
     // which match the filter, and then return a list of matching
@@ -926,23 +2458,85 @@ void SeasideFilteredModel::populateIndex()
     const bool sortLastNameFirst = sortProperty().compare(QStringLiteral("lastName"), Qt::CaseInsensitive) == 0;
     QVector<QVector<quint32> > priorityBucketedContacts;
     priorityBucketedContacts.fill(QVector<quint32>(), FilterData::sortPriorities(sortLastNameFirst).size());
-    for (int i = 0; i < m_referenceContactIds->count(); ++i) {
-        const quint32 &currContactId(m_referenceContactIds->at(i));
-        if (noFilterSet) {
-            filteredContactIds.append(currContactId);
-        } else {
+    QVector<QPair<qint64, quint32> > rankedMatches;
+    bool ranked = false;
+    if (!m_filterParts.isEmpty() && !m_searchByFirstNameCharacter) {
+        // Look up the contacts matching each search term in the shared index, rather than
+        // testing every contact in the reference list
+        SearchIndex *index = SearchIndex::instance();
+        if (!m_searchIndexed) {
+            QList<SeasideCache::CacheItem *> items;
+            items.reserve(m_referenceContactIds->count());
+            for (int i = 0; i < m_referenceContactIds->count(); ++i) {
+                if (SeasideCache::CacheItem *item = existingItem(m_referenceContactIds->at(i)))
+                    items.append(item);
+            }
+            index->addItems(items);
+            m_searchIndexed = true;
+        }
+
+        QVector<QVector<QPair<int, quint32> > > priorityBucketedRows(priorityBucketedContacts.size());
+        const SearchIndex::KeyType keyType = m_searchMode == T9Search ? SearchIndex::DialPadKeys : SearchIndex::TextKeys;
+        QHash<quint32, int> scores;
+        const QHash<quint32, int> matches(index->search(m_filterParts, sortLastNameFirst, nullptr, keyType, isFuzzy(),
+                                                        m_rankedSearch ? &scores : nullptr));
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        ranked = m_rankedSearch;
+        for (QHash<quint32, int>::const_iterator it = matches.cbegin(); it != matches.cend(); ++it) {
+            const int row = m_referenceContactIds->indexOf(it.key());
+            if (row == -1)
+                continue;
+
+            SeasideCache::CacheItem *item = existingItem(it.key());
+            if (!item || !hasRequiredProperty(item))
+                continue;
+
+            item->filterMatchRole = FilterData::sortPriorities(sortLastNameFirst)[it.value()].field;
+            if (ranked) {
+                rankedMatches.append(qMakePair(rankKey(scores.value(it.key()) + contactScore(item, now), row), it.key()));
+            } else {
+                priorityBucketedRows[it.value()].append(qMakePair(row, it.key()));
+            }
+            filteredPriorities.insert(it.key(), it.value());
+        }
+
+        // Within each priority, contacts retain the order of the reference list
+        for (int i = 0; i < priorityBucketedRows.count(); ++i) {
+            QVector<QPair<int, quint32> > &rows(priorityBucketedRows[i]);
+            std::sort(rows.begin(), rows.end());
+            priorityBucketedContacts[i].reserve(rows.count());
+            for (const QPair<int, quint32> &row : rows)
+                priorityBucketedContacts[i].append(row.second);
+        }
+    } else if (noFilterSet) {
+        filteredContactIds = m_referenceContactIds->toList();
+    } else {
+        for (int i = 0; i < m_referenceContactIds->count(); ++i) {
+            const quint32 currContactId = m_referenceContactIds->at(i);
             const int bestMatchPriority = filterId(currContactId);
             if (bestMatchPriority >= 0) {
                 // insert into the appropriate bucket which allows
                 // a total sort order to be generated.
                 priorityBucketedContacts[bestMatchPriority].append(currContactId);
+                filteredPriorities.insert(currContactId, bestMatchPriority);
             }
         }
     }
 
-    if (!noFilterSet) {
+    if (ranked) {
+        // Ordering every match of a short pattern is wasted beyond the visible rows
+        if (limit < 0)
+            limit = initialResultCount;
+        filteredContactIds = rankedContactIds(&rankedMatches, limit);
+    } else if (!noFilterSet) {
         filteredContactIds = sortedContactIds(priorityBucketedContacts);
     }
+    m_filteredPriorities = filteredPriorities;
+
+    // Any pending search is superseded; if limited, the remaining results are appended later
+    m_pendingSearch = NoSearch;
+    deferSearchResults(&filteredContactIds, rankedMatches, limit);
+    updateSearching();
 
     // Check to see if contacts were merely added or removed in one
     // contiguous chunk at the front or back.  If so, can signal
@@ -953,17 +2547,18 @@ void SeasideFilteredModel::populateIndex()
     // Note: don't use synchronizeLists(), as populateSectionBucketIndices()
     // is expensive, so we want to do that at most once per populateIndex().
     bool removeAndInsertAll = false;
+    const QList<quint32> oldContactIds(m_filteredContactIds);
     const int newSize = filteredContactIds.size();
-    const int oldSize = m_filteredContactIds.size();
+    const int oldSize = oldContactIds.size();
     const int sizeDelta = newSize - oldSize;
     int filterDataChangedStartRow = 0;
     int filterDataChangedEndRow = newSize - 1;
     if (sizeDelta > 0) {
-        if (filteredContactIds.mid(0, oldSize) == m_filteredContactIds) {
+        if (filteredContactIds.mid(0, oldSize) == oldContactIds) {
             // appending new rows
             beginInsertRows(QModelIndex(), oldSize, newSize - 1);
             filterDataChangedEndRow = oldSize > 0 ? oldSize - 1 : 0;
-        } else if (filteredContactIds.mid(sizeDelta, oldSize) == m_filteredContactIds) {
+        } else if (filteredContactIds.mid(sizeDelta, oldSize) == oldContactIds) {
             // prepending new rows
             beginInsertRows(QModelIndex(), 0, sizeDelta - 1);
             filterDataChangedStartRow = newSize > sizeDelta ? sizeDelta : newSize - 1;
@@ -971,18 +2566,20 @@ void SeasideFilteredModel::populateIndex()
             removeAndInsertAll = true;
         }
     } else if (sizeDelta < 0) {
-        if (m_filteredContactIds.mid(0, newSize) == filteredContactIds) {
+        if (oldContactIds.mid(0, newSize) == filteredContactIds) {
             // chopping from the tail
             beginRemoveRows(QModelIndex(), newSize, oldSize - 1);
-        } else if (m_filteredContactIds.mid(-sizeDelta, newSize) == filteredContactIds) {
+        } else if (oldContactIds.mid(-sizeDelta, newSize) == filteredContactIds) {
             // chopping from the head
             beginRemoveRows(QModelIndex(), 0, -sizeDelta - 1);
         } else {
             removeAndInsertAll = true;
         }
     } else { // sizeDelta == 0
-        if (filteredContactIds == m_filteredContactIds) {
-            return; // no changes, no need to emit anything.
+        if (filteredContactIds == oldContactIds) {
+            // no changes to the list, but the matching ranges may differ
+            updateFilterMatchRanges();
+            return;
         }
         removeAndInsertAll = true;
     }
@@ -1000,7 +2597,7 @@ void SeasideFilteredModel::populateIndex()
     }
 
     m_filteredContactIds = filteredContactIds;
-    m_contactIds = &m_filteredContactIds;
+    m_usingFilteredIndex = true;
     populateSectionBucketIndices();
 
     if (removeAndInsertAll && !filteredContactIds.isEmpty()) {
@@ -1020,6 +2617,7 @@ void SeasideFilteredModel::populateIndex()
                          createIndex(filterDataChangedEndRow, 0),
                          changedRoles);
     }
+    updateFilterMatchRanges();
 }
 
 /*!
@@ -1027,7 +2625,7 @@ void SeasideFilteredModel::populateIndex()
 */
 QVariantMap SeasideFilteredModel::get(int row) const
 {
-    SeasideCache::CacheItem *cacheItem = existingItem(m_contactIds->at(row));
+    SeasideCache::CacheItem *cacheItem = existingItem(contactIdAt(row));
     if (!cacheItem)
         return QVariantMap();
 
@@ -1058,6 +2656,7 @@ QVariantMap SeasideFilteredModel::get(int row) const
     m.insert(nameDetailsRole, data(cacheItem, NameDetailsRole));
     m.insert(filterMatchDataRole, data(cacheItem, FilterMatchDataRole));
     m.insert(addressBookRole, data(cacheItem, AddressBookRole));
+    m.insert(filterMatchRangesRole, data(cacheItem, FilterMatchRangesRole));
     return m;
 }
 
@@ -1066,7 +2665,7 @@ QVariantMap SeasideFilteredModel::get(int row) const
 */
 QVariant SeasideFilteredModel::get(int row, int role) const
 {
-    SeasideCache::CacheItem *cacheItem = existingItem(m_contactIds->at(row));
+    SeasideCache::CacheItem *cacheItem = existingItem(contactIdAt(row));
     if (!cacheItem)
         return QVariant();
 
@@ -1132,10 +2731,10 @@ bool SeasideFilteredModel::savePeople(const QVariantList &people)
 */
 SeasidePerson *SeasideFilteredModel::personByRow(int row) const
 {
-    if(row < 0 || row >= m_contactIds->size()) {
+    if(row < 0 || row >= contactCount()) {
         return NULL;
     }
-    return personFromItem(SeasideCache::itemById(m_contactIds->at(row)));
+    return personFromItem(SeasideCache::itemById(contactIdAt(row)));
 }
 
 /*!
@@ -1206,7 +2805,7 @@ void SeasideFilteredModel::removePeople(const QVariantList &people)
 
 QModelIndex SeasideFilteredModel::index(const QModelIndex &parent, int row, int column) const
 {
-    return !parent.isValid() && column == 0 && row >= 0 && row < m_contactIds->count()
+    return !parent.isValid() && column == 0 && row >= 0 && row < contactCount()
             ? createIndex(row, column)
             : QModelIndex();
 }
@@ -1217,7 +2816,7 @@ QModelIndex SeasideFilteredModel::index(const QModelIndex &parent, int row, int
 int SeasideFilteredModel::rowCount(const QModelIndex &parent) const
 {
     return !parent.isValid()
-            ? m_contactIds->count()
+            ? contactCount()
             : 0;
 }
 
@@ -1226,7 +2825,7 @@ QVariant SeasideFilteredModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    SeasideCache::CacheItem *cacheItem = existingItem(m_contactIds->at(index.row()));
+    SeasideCache::CacheItem *cacheItem = existingItem(contactIdAt(index.row()));
     if (!cacheItem)
         return QVariant();
 
@@ -1312,6 +2911,8 @@ QVariant SeasideFilteredModel::data(SeasideCache::CacheItem *cacheItem, int role
         return SeasidePerson::role(contact);
     } else if (role == NameDetailsRole) {
         return QVariant();
+    } else if (role == FilterMatchRangesRole) {
+        return filterMatchRanges(cacheItem);
     } else if (role == FilterMatchDataRole) {
         // Return the data which matched the filter pattern.
         // If it was name data, don't return it, as the
@@ -1385,8 +2986,15 @@ void SeasideFilteredModel::sourceAboutToInsertItems(int begin, int end)
 
 void SeasideFilteredModel::sourceItemsInserted(int begin, int end)
 {
-    Q_UNUSED(begin)
-    Q_UNUSED(end)
+    if (m_searchIndexed) {
+        // Keep the search index covering our reference list
+        QList<SeasideCache::CacheItem *> items;
+        for (int i = begin; i <= end && i < m_referenceContactIds->count(); ++i) {
+            if (SeasideCache::CacheItem *item = existingItem(m_referenceContactIds->at(i)))
+                items.append(item);
+        }
+        SearchIndex::instance()->addItems(items);
+    }
 
     if (!isFiltered()) {
         endInsertRows();
@@ -1405,6 +3013,44 @@ void SeasideFilteredModel::sourceDataChanged(int begin, int end)
     }
 }
 
+void SeasideFilteredModel::sourceDataChanged(int begin, int end, quint32 changes)
+{
+    // Avatar and favorite status do not affect filter matching, though favorites are ranked higher
+    const quint32 unfilteredChanges = m_rankedSearch
+            ? SeasideCache::AvatarDataChanged
+            : SeasideCache::AvatarDataChanged | SeasideCache::FavoriteDataChanged;
+
+    const QVector<int> roles(changedRoles(changes));
+    if (!isFiltered()) {
+        emit dataChanged(createIndex(begin, 0), createIndex(end, 0), roles);
+    } else if (changes & ~unfilteredChanges) {
+        sourceDataChanged(begin, end);
+    } else {
+        // Report the change for those of these contacts present in the filtered index,
+        // walking the filtered list once rather than searching it for each contact
+        QSet<quint32> changedIds;
+        const int last = qMin(end, m_referenceContactIds->count() - 1);
+        changedIds.reserve(qMax(last - begin + 1, 0));
+        for (int row = begin; row <= last; ++row)
+            changedIds.insert(m_referenceContactIds->at(row));
+
+        const int count = m_filteredContactIds.count();
+        int remaining = changedIds.count();
+        int changedBegin = -1;
+        for (int index = 0; index <= count && (remaining > 0 || changedBegin != -1); ++index) {
+            const bool changed = index < count && remaining > 0 && changedIds.contains(m_filteredContactIds.at(index));
+            if (changed) {
+                --remaining;
+                if (changedBegin == -1)
+                    changedBegin = index;
+            } else if (changedBegin != -1) {
+                emit dataChanged(createIndex(changedBegin, 0), createIndex(index - 1, 0), roles);
+                changedBegin = -1;
+            }
+        }
+    }
+}
+
 void SeasideFilteredModel::sourceItemsChanged()
 {
     if (isFiltered()) {
@@ -1418,8 +3064,45 @@ void SeasideFilteredModel::sourceItemsChanged()
     }
 }
 
+void SeasideFilteredModel::sourceAboutToChangeLayout()
+{
+    if (!isFiltered()) {
+        emit layoutAboutToBeChanged();
+
+        // Record the contacts at the persistent indexes, to find their rows after reordering
+        m_layoutIndexes = persistentIndexList();
+        m_layoutContactIds.clear();
+        m_layoutContactIds.reserve(m_layoutIndexes.count());
+        for (const QModelIndex &index : m_layoutIndexes) {
+            m_layoutContactIds.append(contactIdAt(index.row()));
+        }
+    }
+}
+
+void SeasideFilteredModel::sourceLayoutChanged()
+{
+    if (!isFiltered()) {
+        QModelIndexList newIndexes;
+        newIndexes.reserve(m_layoutIndexes.count());
+        for (int i = 0; i < m_layoutIndexes.count(); ++i) {
+            const int row = m_referenceContactIds->indexOf(m_layoutContactIds.at(i));
+            newIndexes.append(row != -1 ? index(row, m_layoutIndexes.at(i).column()) : QModelIndex());
+        }
+        changePersistentIndexList(m_layoutIndexes, newIndexes);
+
+        m_layoutIndexes.clear();
+        m_layoutContactIds.clear();
+
+        emit layoutChanged();
+    } else {
+        // The filtered index is ordered by the source list within each match priority
+        updateIndex();
+    }
+}
+
 void SeasideFilteredModel::makePopulated()
 {
+    prewarmSearchIndex();
     emit populatedChanged();
 }
 
@@ -1474,10 +3157,32 @@ QString SeasideFilteredModel::exportContacts()
     return SeasideCache::exportContacts();
 }
 
+/*!
+  \qmlmethod void PeopleModel::prepareSearchFilters()
+
+  Schedules the search keys of all contacts to be prepared while the application is idle.
+  This is done automatically once the model is populated.
+*/
 void SeasideFilteredModel::prepareSearchFilters()
 {
-    m_filterUpdateIndex = 0;
-    updateSearchFilters();
+    prewarmSearchIndex();
+}
+
+/*!
+  \qmlmethod void PeopleModel::recordContactUse(int contactId)
+
+  Records that the contact with \a contactId has been used, such as by being called
+  or messaged, so that it ranks higher in later searches of models with rankedSearch set.
+
+  Uses are recorded in memory only, and are discarded when the process exits.
+*/
+void SeasideFilteredModel::recordContactUse(int contactId)
+{
+    if (SeasideCache::CacheItem *item = SeasideCache::itemById(contactId, false)) {
+        ContactUsage::instance()->record(item->iid);
+    } else {
+        qWarning() << "Unable to record use of unknown contact:" << contactId;
+    }
 }
 
 void SeasideFilteredModel::populateSectionBucketIndices()
@@ -1489,9 +3194,9 @@ void SeasideFilteredModel::populateSectionBucketIndices()
     }
 
     QString prevHandledSectionBucket;
-    for (int i = 0, j = 0; i < m_contactIds->size() && j < allSectionBuckets.size(); ++i) {
+    for (int i = 0, j = 0; i < contactCount() && j < allSectionBuckets.size(); ++i) {
         const QString &currSectionBucket(allSectionBuckets[j]);
-        SeasideCache::CacheItem *cacheItem = SeasideCache::itemById(m_contactIds->at(i));
+        SeasideCache::CacheItem *cacheItem = SeasideCache::itemById(contactIdAt(i));
         if (!cacheItem) {
             continue;
         }
@@ -1553,6 +3258,18 @@ int SeasideFilteredModel::firstIndexInGroup(const QString &sectionBucket)
     return -1;
 }
 
+/*!
+  \qmlmethod object PeopleModel::cacheStatistics()
+
+  Returns the current statistics of the shared contact cache, including the number of
+  contacts held with complete details, their estimated size, the memory budget for them
+  and the number of contacts demoted to meet that budget.
+*/
+QVariantMap SeasideFilteredModel::cacheStatistics() const
+{
+    return SeasideCache::cacheStatistics();
+}
+
 SeasidePerson *SeasideFilteredModel::personFromItem(SeasideCache::CacheItem *item) const
 {
     if (!item)
@@ -1567,6 +3284,16 @@ SeasidePerson *SeasideFilteredModel::personFromItem(SeasideCache::CacheItem *ite
     return static_cast<SeasidePerson *>(item->itemData);
 }
 
+int SeasideFilteredModel::contactCount() const
+{
+    return m_usingFilteredIndex ? m_filteredContactIds.count() : m_referenceContactIds->count();
+}
+
+quint32 SeasideFilteredModel::contactIdAt(int row) const
+{
+    return m_usingFilteredIndex ? m_filteredContactIds.at(row) : m_referenceContactIds->at(row);
+}
+
 bool SeasideFilteredModel::isFiltered() const
 {
     return m_effectiveFilterType != FilterNone
@@ -1580,8 +3307,14 @@ void SeasideFilteredModel::updateFilters(const QString &pattern, int property)
 
     const bool filtered = isFiltered();
     const bool removeFilter = pattern.isEmpty() && property == NoPropertyRequired;
+    // A longer pattern may tolerate more edits, so fuzzy matches are never refined. Nor are
+    // display label group matches, as a longer group (such as 'Ch') does not match within
+    // the contacts of its prefix group
     const bool refinement = (pattern == m_filterPattern || pattern.startsWith(m_filterPattern, Qt::CaseInsensitive))
-            && (property == m_requiredProperty || m_requiredProperty == NoPropertyRequired);
+            && (property == m_requiredProperty || m_requiredProperty == NoPropertyRequired)
+            && (pattern == m_filterPattern || (!isFuzzy() && !m_searchByFirstNameCharacter));
+    // Removing the filter requires no evaluation, so it is never deferred
+    const bool deferred = m_asynchronousSearch && !removeFilter;
 
     const int prevCount = rowCount();
 
@@ -1590,11 +3323,7 @@ void SeasideFilteredModel::updateFilters(const QString &pattern, int property)
 
     if (m_filterPattern != pattern) {
         m_filterPattern = pattern;
-        m_filterParts = extractSearchTerms(m_filterPattern);
-        // Qt5 does not recognize '#' as a word
-        if (m_filterParts.isEmpty() && !pattern.isEmpty()) {
-            m_filterParts.append(QStringList() << pattern);
-        }
+        updateFilterParts();
         changedPattern = true;
     }
     if (m_requiredProperty != property) {
@@ -1611,20 +3340,30 @@ void SeasideFilteredModel::updateFilters(const QString &pattern, int property)
         updateRegistration();
 
         m_referenceContactIds = m_allContactIds;
-        populateIndex();
+        m_searchIndexed = false;
+        if (deferred) {
+            scheduleSearch(PopulateSearch);
+        } else {
+            populateIndex();
+        }
     } else if (m_filterType == FilterNone && m_effectiveFilterType == FilterAll && m_filterPattern.isEmpty()) {
         // We should no longer show any results
         m_effectiveFilterType = FilterNone;
         updateRegistration();
 
-        const bool hadMatches = m_contactIds->count() > 0;
+        m_pendingSearch = NoSearch;
+        m_pendingContactIds.clear();
+        m_pendingRanks.clear();
+
+        const bool hadMatches = contactCount() > 0;
         if (hadMatches) {
-            beginRemoveRows(QModelIndex(), 0, m_contactIds->count() - 1);
-            invalidateRows(0, m_contactIds->count(), true, false);
+            beginRemoveRows(QModelIndex(), 0, contactCount() - 1);
+            invalidateRows(0, contactCount(), true, false);
         }
 
-        m_referenceContactIds = SeasideCache::contacts(SeasideCache::FilterNone);
-        m_contactIds = m_referenceContactIds;
+        m_referenceContactIds = SeasideCache::contactIdList(SeasideCache::FilterNone);
+        m_searchIndexed = false;
+        m_usingFilteredIndex = false;
         m_filteredContactIds.clear();
         populateSectionBucketIndices();
 
@@ -1632,24 +3371,37 @@ void SeasideFilteredModel::updateFilters(const QString &pattern, int property)
             endRemoveRows();
         }
     } else if (!filtered) {
-        m_filteredContactIds = *m_referenceContactIds;
-        m_contactIds = &m_filteredContactIds;
-        refineIndex();
-        populateSectionBucketIndices();
+        m_filteredContactIds = m_referenceContactIds->toList();
+        m_filteredPriorities.clear();
+        m_usingFilteredIndex = true;
+        if (deferred) {
+            scheduleSearch(RefineSearch);
+        } else {
+            refineIndex();
+            populateSectionBucketIndices();
+        }
     } else if (refinement) {
-        refineIndex();
-        populateSectionBucketIndices();
+        if (deferred) {
+            scheduleSearch(RefineSearch);
+        } else {
+            refineIndex();
+            populateSectionBucketIndices();
+        }
+    } else if (deferred) {
+        scheduleSearch(PopulateSearch);
     } else {
         updateIndex();
 
         if (removeFilter) {
-            m_contactIds = m_referenceContactIds;
+            m_usingFilteredIndex = false;
             m_filteredContactIds.clear();
         }
 
         populateSectionBucketIndices();
     }
 
+    updateSearching();
+
     if (rowCount() != prevCount) {
         emit countChanged();
     }
@@ -1661,6 +3413,23 @@ void SeasideFilteredModel::updateFilters(const QString &pattern, int property)
     }
 }
 
+void SeasideFilteredModel::updateFilterParts()
+{
+    // Ranges read before the changed filter is evaluated must not be those of the previous filter
+    ++m_filterGeneration;
+
+    if (m_searchMode == T9Search) {
+        m_filterParts = extractDialPadTerms(m_filterPattern);
+        return;
+    }
+
+    m_filterParts = extractSearchTerms(m_filterPattern);
+    // Qt5 does not recognize '#' as a word
+    if (m_filterParts.isEmpty() && !m_filterPattern.isEmpty()) {
+        m_filterParts.append(QStringList() << m_filterPattern);
+    }
+}
+
 void SeasideFilteredModel::updateRegistration()
 {
     const SeasideCache::FetchDataType requiredTypes(static_cast<SeasideCache::FetchDataType>(m_requiredProperty));
@@ -1674,11 +3443,9 @@ void SeasideFilteredModel::updateRegistration()
 
 void SeasideFilteredModel::invalidateRows(int begin, int count, bool filteredIndex, bool removeFromModel)
 {
-    const QList<quint32> *contactIds(filteredIndex ? &m_filteredContactIds
-                                                   : m_referenceContactIds);
-
     for (int index = begin; index < (begin + count); ++index) {
-        if (contactIds->at(index) == m_lastId) {
+        const quint32 iid = filteredIndex ? m_filteredContactIds.at(index) : m_referenceContactIds->at(index);
+        if (iid == m_lastId) {
             m_lastId = 0;
             m_lastItem = 0;
         }
@@ -1693,6 +3460,23 @@ void SeasideFilteredModel::invalidateRows(int begin, int count, bool filteredInd
     }
 }
 
+int SeasideFilteredModel::insertRange(int index, int count, const QList<quint32> &source, int sourceIndex)
+{
+    beginInsertRows(QModelIndex(), index, index + count - 1);
+    for (int i = 0; i < count; ++i)
+        m_filteredContactIds.insert(index + i, source.at(sourceIndex + i));
+    endInsertRows();
+    return count;
+}
+
+int SeasideFilteredModel::removeRange(int index, int count)
+{
+    beginRemoveRows(QModelIndex(), index, index + count - 1);
+    invalidateRows(index, count);
+    endRemoveRows();
+    return 0;
+}
+
 SeasideCache::CacheItem *SeasideFilteredModel::existingItem(quint32 iid) const
 {
     // Cache the last item lookup - repeated property lookups will be for the same index
@@ -1703,37 +3487,153 @@ SeasideCache::CacheItem *SeasideFilteredModel::existingItem(quint32 iid) const
     return m_lastItem;
 }
 
-void SeasideFilteredModel::updateSearchFilters()
+void SeasideFilteredModel::prewarmSearchIndex()
 {
-    static const int maxBatchSize = 100;
+    SeasideSearchPrewarmer *prewarmer = SeasideSearchPrewarmer::instance();
+    prewarmer->setPreparer([](const QList<SeasideCache::CacheItem *> &items) {
+        SearchIndex::instance()->addItems(items);
+    });
 
-    for (int n = 0; m_filterUpdateIndex < m_allContactIds->count(); ++m_filterUpdateIndex) {
-        SeasideCache::CacheItem *item = existingItem(m_allContactIds->at(m_filterUpdateIndex));
-        if (!item)
+    // The leading rows are likely to be visible, and favorites are likely to be sought
+    SearchIndex *index = SearchIndex::instance();
+    for (int i = 0; i < contactCount() && i < initialResultCount; ++i) {
+        SeasideCache::CacheItem *item = existingItem(contactIdAt(i));
+        if (item && !index->isIndexed(item))
+            prewarmer->schedule(item->iid, SeasideSearchPrewarmer::VisiblePriority);
+    }
+
+    for (int i = 0; i < m_allContactIds->count(); ++i) {
+        SeasideCache::CacheItem *item = existingItem(m_allContactIds->at(i));
+        if (!item || index->isIndexed(item))
             continue;
 
-        FilterData *filterData = FilterData::getItemFilterData(item, this);
-        if (filterData->prepareFilter(item, sortProperty())) {
-            if (++n == maxBatchSize) {
-                // Schedule further processing
-                QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
-                return;
-            }
+        prewarmer->schedule(item->iid, isFavorite(item) ? SeasideSearchPrewarmer::FavoritePriority
+                                                        : SeasideSearchPrewarmer::BackgroundPriority);
+    }
+}
+
+void SeasideFilteredModel::scheduleSearch(PendingSearch search)
+{
+    // Only the complete result list can be refined
+    if (search == PopulateSearch || m_pendingSearch == PopulateSearch || !m_pendingContactIds.isEmpty()) {
+        m_pendingSearch = PopulateSearch;
+    } else {
+        m_pendingSearch = RefineSearch;
+    }
+    m_pendingContactIds.clear();
+    m_pendingRanks.clear();
+
+    scheduleSearchEvent();
+}
+
+void SeasideFilteredModel::scheduleSearchEvent()
+{
+    if (!m_searchScheduled) {
+        m_searchScheduled = true;
+        QCoreApplication::postEvent(this, new QEvent(searchEventType));
+    }
+}
+
+// Retains the results beyond limit to be appended in later steps
+void SeasideFilteredModel::deferSearchResults(QList<quint32> *contactIds, const QVector<QPair<qint64, quint32> > &rankedMatches, int limit)
+{
+    m_pendingContactIds.clear();
+    m_pendingRanks.clear();
+    if (limit >= 0 && contactIds->count() > limit) {
+        m_pendingContactIds = contactIds->mid(limit);
+        contactIds->erase(contactIds->begin() + limit, contactIds->end());
+
+        // The remaining results of a ranked search are only ordered as they are delivered
+        for (int i = limit; i < rankedMatches.count(); ++i)
+            m_pendingRanks.insert(rankedMatches.at(i).second, rankedMatches.at(i).first);
+        scheduleSearchEvent();
+    }
+}
+
+void SeasideFilteredModel::evaluateSearch()
+{
+    if (!m_searchIndexed && !m_filterParts.isEmpty() && !m_searchByFirstNameCharacter) {
+        // Build the search index in steps, so that further changes to the filter can be
+        // accepted; only the filter current when the index is complete will be evaluated
+        SearchIndex *index = SearchIndex::instance();
+        QList<SeasideCache::CacheItem *> items;
+        for (int i = 0; i < m_referenceContactIds->count() && items.count() < indexBatchSize; ++i) {
+            SeasideCache::CacheItem *item = existingItem(m_referenceContactIds->at(i));
+            if (item && !index->isIndexed(item))
+                items.append(item);
+        }
+        index->addItems(items);
+
+        if (items.count() == indexBatchSize) {
+            scheduleSearchEvent();
+            return;
         }
+        m_searchIndexed = true;
+    }
+
+    const int prevCount = rowCount();
+
+    const PendingSearch search = m_pendingSearch;
+    m_pendingSearch = NoSearch;
+    if (search == RefineSearch) {
+        refineIndex();
+        populateSectionBucketIndices();
+    } else {
+        populateIndex(initialResultCount);
+    }
+
+    ++m_searchGeneration;
+    updateSearching();
+
+    if (rowCount() != prevCount) {
+        emit countChanged();
+    }
+    emit searchGenerationChanged();
+}
+
+void SeasideFilteredModel::deliverSearchResults()
+{
+    const int count = qMin(resultBatchSize, m_pendingContactIds.count());
+    if (!m_pendingRanks.isEmpty()) {
+        // Order only the results of a ranked search delivered in this step
+        const QHash<quint32, qint64> &ranks(m_pendingRanks);
+        std::partial_sort(m_pendingContactIds.begin(), m_pendingContactIds.begin() + count, m_pendingContactIds.end(),
+                          [&ranks](quint32 lhs, quint32 rhs) { return ranks.value(lhs) < ranks.value(rhs); });
+        for (int i = 0; i < count; ++i)
+            m_pendingRanks.remove(m_pendingContactIds.at(i));
+    }
+    insertRange(m_filteredContactIds.count(), count, m_pendingContactIds, 0);
+    m_pendingContactIds.erase(m_pendingContactIds.begin(), m_pendingContactIds.begin() + count);
+    populateSectionBucketIndices();
+
+    if (!m_pendingContactIds.isEmpty()) {
+        scheduleSearchEvent();
     }
+    updateSearching();
 
-    // Nothing left to process
-    m_filterUpdateIndex = -1;
+    emit countChanged();
 }
 
-bool SeasideFilteredModel::event(QEvent *event)
+void SeasideFilteredModel::updateSearching()
 {
-    if (event->type() != QEvent::UpdateRequest)
-        return QObject::event(event);
+    const bool searching = m_pendingSearch != NoSearch || !m_pendingContactIds.isEmpty();
+    if (m_searching != searching) {
+        m_searching = searching;
+        emit searchingChanged();
+    }
+}
 
-    if (m_filterUpdateIndex != -1) {
-        updateSearchFilters();
+bool SeasideFilteredModel::event(QEvent *event)
+{
+    if (event->type() == searchEventType) {
+        m_searchScheduled = false;
+        if (m_pendingSearch != NoSearch) {
+            evaluateSearch();
+        } else if (!m_pendingContactIds.isEmpty()) {
+            deliverSearchResults();
+        }
+        return true;
     }
 
-    return true;
+    return QObject::event(event);
 }
@@ -55,9 +55,16 @@ class SeasideFilteredModel : public SeasideCache::ListModel
     Q_PROPERTY(int requiredProperty READ requiredProperty WRITE setRequiredProperty NOTIFY requiredPropertyChanged)
     Q_PROPERTY(int searchableProperty READ searchableProperty WRITE setSearchableProperty NOTIFY searchablePropertyChanged)
     Q_PROPERTY(bool searchByFirstNameCharacter READ searchByFirstNameCharacter WRITE setSearchByFirstNameCharacter NOTIFY searchByFirstNameCharacterChanged)
+    Q_PROPERTY(SearchMode searchMode READ searchMode WRITE setSearchMode NOTIFY searchModeChanged)
+    Q_PROPERTY(bool fuzzySearch READ fuzzySearch WRITE setFuzzySearch NOTIFY fuzzySearchChanged)
+    Q_PROPERTY(bool rankedSearch READ rankedSearch WRITE setRankedSearch NOTIFY rankedSearchChanged)
+    Q_PROPERTY(bool asynchronousSearch READ asynchronousSearch WRITE setAsynchronousSearch NOTIFY asynchronousSearchChanged)
+    Q_PROPERTY(bool searching READ isSearching NOTIFY searchingChanged)
+    Q_PROPERTY(int searchGeneration READ searchGeneration NOTIFY searchGenerationChanged)
+    Q_PROPERTY(qreal searchIndexProgress READ searchIndexProgress NOTIFY searchIndexProgressChanged)
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
     Q_PROPERTY(QString placeholderDisplayLabel READ placeholderDisplayLabel CONSTANT)
-    Q_ENUMS(FilterType RequiredPropertyType SearchablePropertyType DisplayLabelOrder)
+    Q_ENUMS(FilterType RequiredPropertyType SearchablePropertyType DisplayLabelOrder SearchMode)
 
 public:
     enum FilterType {
@@ -83,6 +90,11 @@ public:
         OrganizationSearchable = SeasideCache::FetchOrganization
     };
 
+    enum SearchMode {
+        TextSearch = 0,
+        T9Search
+    };
+
     enum DisplayLabelOrder {
         FirstNameFirst = SeasideCache::FirstNameFirst,
         LastNameFirst = SeasideCache::LastNameFirst
@@ -114,7 +126,8 @@ public:
         RoleRole,
         NameDetailsRole,
         FilterMatchDataRole,
-        AddressBookRole
+        AddressBookRole,
+        FilterMatchRangesRole
     };
     Q_ENUM(PeopleRoles)
 
@@ -138,6 +151,22 @@ public:
     bool searchByFirstNameCharacter() const;
     void setSearchByFirstNameCharacter(bool searchByFirstNameCharacter);
 
+    SearchMode searchMode() const;
+    void setSearchMode(SearchMode mode);
+
+    bool fuzzySearch() const;
+    void setFuzzySearch(bool fuzzySearch);
+
+    bool rankedSearch() const;
+    void setRankedSearch(bool rankedSearch);
+
+    bool asynchronousSearch() const;
+    void setAsynchronousSearch(bool asynchronousSearch);
+
+    bool isSearching() const;
+    int searchGeneration() const;
+    qreal searchIndexProgress() const;
+
     DisplayLabelOrder displayLabelOrder() const;
     void setDisplayLabelOrder(DisplayLabelOrder order);
 
@@ -164,8 +193,11 @@ public:
     Q_INVOKABLE QString exportContacts();
 
     Q_INVOKABLE void prepareSearchFilters();
+    Q_INVOKABLE void recordContactUse(int contactId);
     Q_INVOKABLE int firstIndexInGroup(const QString &sectionBucket);
 
+    Q_INVOKABLE QVariantMap cacheStatistics() const;
+
     QModelIndex index(const QModelIndex &parent, int row, int column) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role) const;
@@ -187,9 +219,13 @@ public:
     void sourceItemsInserted(int begin, int end);
 
     void sourceDataChanged(int begin, int end);
+    void sourceDataChanged(int begin, int end, quint32 changes);
 
     void sourceItemsChanged();
 
+    void sourceAboutToChangeLayout();
+    void sourceLayoutChanged();
+
     void makePopulated();
 
     void updateDisplayLabelOrder();
@@ -200,6 +236,10 @@ public:
 
     void saveContactComplete(int localId, int aggregateId);
 
+    // For synchronizeLists()
+    int insertRange(int index, int count, const QList<quint32> &source, int sourceIndex);
+    int removeRange(int index, int count);
+
 signals:
     void populatedChanged();
     void filterTypeChanged();
@@ -207,6 +247,13 @@ signals:
     void requiredPropertyChanged();
     void searchablePropertyChanged();
     void searchByFirstNameCharacterChanged();
+    void searchModeChanged();
+    void fuzzySearchChanged();
+    void rankedSearchChanged();
+    void asynchronousSearchChanged();
+    void searchingChanged();
+    void searchGenerationChanged();
+    void searchIndexProgressChanged();
     void displayLabelOrderChanged();
     void sortPropertyChanged();
     void groupPropertyChanged();
@@ -215,21 +262,41 @@ signals:
     void savePersonFailed();
 
 private:
-    void populateIndex();
+    enum PendingSearch {
+        NoSearch = 0,
+        RefineSearch,
+        PopulateSearch
+    };
+
+    void populateIndex(int limit = -1);
     void refineIndex();
     void updateIndex();
     void updateRegistration();
 
+    int contactCount() const;
+    quint32 contactIdAt(int row) const;
     bool isFiltered() const;
+    bool isFuzzy() const;
     void updateFilters(const QString &pattern, int property);
+    void updateFilterParts();
 
     void invalidateRows(int begin, int count, bool filteredIndex = true, bool removeFromModel = true);
 
     SeasideCache::CacheItem *existingItem(quint32 iid) const;
+    bool hasRequiredProperty(SeasideCache::CacheItem *item) const;
+    QVariantList filterMatchRanges(SeasideCache::CacheItem *item) const;
+    void updateFilterMatchRanges();
 
     SeasidePerson *personFromItem(SeasideCache::CacheItem *item) const;
 
-    void updateSearchFilters();
+    void prewarmSearchIndex();
+
+    void scheduleSearch(PendingSearch search);
+    void scheduleSearchEvent();
+    void deferSearchResults(QList<quint32> *contactIds, const QVector<QPair<qint64, quint32> > &rankedMatches, int limit);
+    void evaluateSearch();
+    void deliverSearchResults();
+    void updateSearching();
 
     void populateSectionBucketIndices();
 
@@ -237,18 +304,33 @@ private:
 
     QMap<QString, int> m_firstIndexForSectionBucket;
     QList<quint32> m_filteredContactIds;
-    const QList<quint32> *m_contactIds;
-    const QList<quint32> *m_referenceContactIds;
-    const QList<quint32> *m_allContactIds;
+    QHash<quint32, int> m_filteredPriorities;
+    bool m_usingFilteredIndex; // whether the rows are m_filteredContactIds, or the reference list
+    const SeasideContactIdList *m_referenceContactIds;
+    const SeasideContactIdList *m_allContactIds;
     QList<QStringList> m_filterParts;
     QString m_filterPattern;
-    int m_filterUpdateIndex;
     FilterType m_filterType;
     FilterType m_effectiveFilterType;
     int m_requiredProperty;
     int m_searchableProperty;
     bool m_searchByFirstNameCharacter;
     bool m_savePersonActive;
+    bool m_searchIndexed;
+    SearchMode m_searchMode;
+    bool m_fuzzySearch;
+    bool m_rankedSearch;
+    bool m_asynchronousSearch;
+    bool m_searching;
+    bool m_searchScheduled;
+    PendingSearch m_pendingSearch;
+    int m_searchGeneration;
+    int m_filterGeneration;
+    mutable QHash<quint32, QPair<int, QVariantList> > m_filterMatchRanges;
+    QList<quint32> m_pendingContactIds;
+    QHash<quint32, qint64> m_pendingRanks;
+    QModelIndexList m_layoutIndexes;
+    QList<quint32> m_layoutContactIds;
 
     mutable SeasideCache::CacheItem *m_lastItem;
     mutable quint32 m_lastId;
@@ -57,6 +57,7 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QMetaMethod>
 
 QTVERSIT_USE_NAMESPACE
 
@@ -2672,6 +2673,19 @@ void SeasidePerson::aggregationOperationCompleted()
     emit aggregationOperationFinished();
 }
 
+bool SeasidePerson::isActive() const
+{
+    // The person is in use while anything is connected to its signals, such as the
+    // property bindings of a delegate presenting it
+    const QMetaObject *personMetaObject = metaObject();
+    for (int i = QObject::staticMetaObject.methodCount(); i < personMetaObject->methodCount(); ++i) {
+        const QMetaMethod method(personMetaObject->method(i));
+        if (method.methodType() == QMetaMethod::Signal && isSignalConnected(method))
+            return true;
+    }
+    return false;
+}
+
 /*!
   \qmlmethod void Person::aggregateInto(Person person)
 */
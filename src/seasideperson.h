@@ -354,6 +354,7 @@ public:
     void constituentsFetched(const QList<int> &ids);
     void mergeCandidatesFetched(const QList<int> &ids);
     void aggregationOperationCompleted();
+    bool isActive() const;
 
     static QString companyName(const QContact &contact);
     static QString title(const QContact &contact);
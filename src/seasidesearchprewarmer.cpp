@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#include "seasidesearchprewarmer.h"
+
+#include <QPointer>
+
+namespace {
+
+// The number of contacts prepared in each idle step
+const int batchSize = 100;
+
+}
+
+SeasideSearchPrewarmer::SeasideSearchPrewarmer(QObject *parent)
+    : QObject(parent)
+    , m_queues(PriorityCount)
+    , m_total(0)
+    , m_prepared(0)
+{
+    // A zero interval timer fires once the event queue has been processed
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &SeasideSearchPrewarmer::prepareBatch);
+
+    connect(SeasideCache::instance(), &SeasideCache::displayStateChanged,
+            this, &SeasideSearchPrewarmer::displayStateChanged);
+}
+
+SeasideSearchPrewarmer *SeasideSearchPrewarmer::instance()
+{
+    static QPointer<SeasideSearchPrewarmer> prewarmer;
+    if (!prewarmer) {
+        prewarmer = new SeasideSearchPrewarmer(SeasideCache::instance());
+    }
+    return prewarmer;
+}
+
+void SeasideSearchPrewarmer::setPreparer(const Preparer &preparer)
+{
+    m_preparer = preparer;
+}
+
+void SeasideSearchPrewarmer::schedule(quint32 iid, Priority priority)
+{
+    QHash<quint32, Priority>::iterator it = m_scheduled.find(iid);
+    if (it == m_scheduled.end()) {
+        m_scheduled.insert(iid, priority);
+        if (++m_total == 1) {
+            // Later changes are reported as each batch is prepared
+            emit progressChanged();
+        }
+    } else if (priority < *it) {
+        // The entry in the lower priority queue is skipped when reached
+        *it = priority;
+    } else {
+        return;
+    }
+
+    m_queues[priority].append(iid);
+    start();
+}
+
+bool SeasideSearchPrewarmer::isActive() const
+{
+    return !m_scheduled.isEmpty();
+}
+
+qreal SeasideSearchPrewarmer::progress() const
+{
+    return m_total > 0 ? static_cast<qreal>(m_prepared) / m_total : 1.0;
+}
+
+void SeasideSearchPrewarmer::start()
+{
+    // Preparation resumes when the display is next enabled
+    if (!m_timer.isActive() && !m_scheduled.isEmpty() && m_preparer && !SeasideCache::isDisplayOff()) {
+        m_timer.start();
+    }
+}
+
+void SeasideSearchPrewarmer::prepareBatch()
+{
+    if (SeasideCache::isDisplayOff())
+        return;
+
+    QList<SeasideCache::CacheItem *> items;
+    int prepared = 0;
+    for (int priority = VisiblePriority; priority < PriorityCount && prepared < batchSize; ++priority) {
+        QList<quint32> &queue(m_queues[priority]);
+        while (!queue.isEmpty() && prepared < batchSize) {
+            const quint32 iid = queue.takeFirst();
+            QHash<quint32, Priority>::iterator it = m_scheduled.find(iid);
+            if (it == m_scheduled.end() || *it != priority)
+                continue;
+
+            m_scheduled.erase(it);
+            ++prepared;
+            if (SeasideCache::CacheItem *item = SeasideCache::existingItem(iid))
+                items.append(item);
+        }
+    }
+
+    if (!items.isEmpty())
+        m_preparer(items);
+
+    m_prepared += prepared;
+    if (m_scheduled.isEmpty()) {
+        // Progress is reported afresh for any contacts scheduled later
+        m_total = 0;
+        m_prepared = 0;
+        for (QList<quint32> &queue : m_queues)
+            queue.clear();
+    } else {
+        m_timer.start();
+    }
+
+    emit progressChanged();
+}
+
+void SeasideSearchPrewarmer::displayStateChanged()
+{
+    start();
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+#ifndef SEASIDESEARCHPREWARMER_H
+#define SEASIDESEARCHPREWARMER_H
+
+#include <seasidecache.h>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+// Prepares the search keys of the cached contacts while the application is idle, so that
+// searches need not tokenize contacts first. One scheduler is shared by all models, and
+// is discarded with the cache.
+class SeasideSearchPrewarmer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Contacts of a higher priority are prepared first
+    enum Priority {
+        VisiblePriority = 0,
+        FavoritePriority,
+        BackgroundPriority,
+        PriorityCount
+    };
+
+    typedef std::function<void(const QList<SeasideCache::CacheItem *> &)> Preparer;
+
+    static SeasideSearchPrewarmer *instance();
+
+    void setPreparer(const Preparer &preparer);
+
+    // Schedules a contact, or raises the priority of a contact already scheduled
+    void schedule(quint32 iid, Priority priority);
+
+    bool isActive() const;
+
+    // The proportion of the contacts scheduled since the scheduler was last idle that
+    // have been prepared
+    qreal progress() const;
+
+signals:
+    void progressChanged();
+
+private:
+    explicit SeasideSearchPrewarmer(QObject *parent);
+
+    void prepareBatch();
+    void displayStateChanged();
+    void start();
+
+    Preparer m_preparer;
+    QVector<QList<quint32> > m_queues;
+    QHash<quint32, Priority> m_scheduled;
+    QTimer m_timer;
+    int m_total;
+    int m_prepared;
+};
+
+#endif
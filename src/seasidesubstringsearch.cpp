@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include "seasidesubstringsearch.h"
+
+#include <QtAlgorithms>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SEASIDE_SUBSTRING_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SEASIDE_SUBSTRING_NEON
+#endif
+
+namespace {
+
+// Eight UTF-16 code units are compared in each step
+const int blockSize = 8;
+
+}
+
+int SeasideSubstringSearch::commonPrefixLengthScalar(const QChar *lhs, const QChar *rhs, int length)
+{
+    int position = 0;
+    while (position < length && lhs[position] == rhs[position])
+        ++position;
+    return position;
+}
+
+int SeasideSubstringSearch::commonPrefixLength(const QChar *lhs, const QChar *rhs, int length)
+{
+    const ushort *l = reinterpret_cast<const ushort *>(lhs);
+    const ushort *r = reinterpret_cast<const ushort *>(rhs);
+    int position = 0;
+
+#if defined(SEASIDE_SUBSTRING_SSE2)
+    for ( ; position + blockSize <= length; position += blockSize) {
+        const __m128i equal = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(l + position)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + position)));
+
+        // Two mask bits for each unit
+        const quint32 mask = static_cast<quint32>(_mm_movemask_epi8(equal));
+        if (mask != 0xffffu)
+            return position + qCountTrailingZeroBits(~mask) / 2;
+    }
+#elif defined(SEASIDE_SUBSTRING_NEON)
+    for ( ; position + blockSize <= length; position += blockSize) {
+        const uint16x8_t equal = vceqq_u16(vld1q_u16(l + position), vld1q_u16(r + position));
+
+        // Eight mask bits for each unit
+        const quint64 mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(equal)), 0);
+        if (mask != ~Q_UINT64_C(0))
+            return position + qCountTrailingZeroBits(~mask) / 8;
+    }
+#endif
+
+    // Compare any remaining units individually
+    while (position < length && l[position] == r[position])
+        ++position;
+    return position;
+}
+
+int SeasideSubstringSearch::compare(const QChar *lhs, int lhsLength, const QChar *rhs, int rhsLength)
+{
+    const int length = qMin(lhsLength, rhsLength);
+    const int common = commonPrefixLength(lhs, rhs, length);
+    if (common < length)
+        return static_cast<int>(lhs[common].unicode()) - static_cast<int>(rhs[common].unicode());
+    return lhsLength - rhsLength;
+}
+
+bool SeasideSubstringSearch::isVectorized()
+{
+#if defined(SEASIDE_SUBSTRING_SSE2) || defined(SEASIDE_SUBSTRING_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#ifndef SEASIDESUBSTRINGSEARCH_H
+#define SEASIDESUBSTRINGSEARCH_H
+
+#include <QChar>
+
+// Substrings are found in the search index by locating the value among the sorted suffixes
+// of the indexed keys, so searching is dominated by comparing ranges of folded keys. UTF-16
+// code units are compared exactly, so both ranges must already be folded to the same form.
+class SeasideSubstringSearch
+{
+public:
+    // Returns the number of leading code units that are equal in lhs and rhs, up to length
+    static int commonPrefixLength(const QChar *lhs, const QChar *rhs, int length);
+
+    // The portable implementation of commonPrefixLength(), used where no vector unit is available
+    static int commonPrefixLengthScalar(const QChar *lhs, const QChar *rhs, int length);
+
+    // Returns a negative value, zero or a positive value if lhs is ordered before, equal to
+    // or after rhs, comparing their code units
+    static int compare(const QChar *lhs, int lhsLength, const QChar *rhs, int rhsLength);
+
+    static bool isVectorized();
+};
+
+#endif
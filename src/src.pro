@@ -9,7 +9,8 @@ CONFIG += qt plugin hide_symbols
 QT = \
     core  \
     qml   \
-    dbus
+    dbus  \
+    concurrent
 PKGCONFIG += mlocale$${QT_MAJOR_VERSION} accounts-qt$${QT_MAJOR_VERSION}
 
 packagesExist(mlite$${QT_MAJOR_VERSION}) {
@@ -40,6 +41,8 @@ SOURCES += $$PWD/plugin.cpp \
            $$PWD/seasidefilteredmodel.cpp \
            $$PWD/seasidedisplaylabelgroupmodel.cpp \
            $$PWD/seasidestringlistcompressor.cpp \
+           $$PWD/seasidesearchprewarmer.cpp \
+           $$PWD/seasidesubstringsearch.cpp \
            $$PWD/seasidevcardmodel.cpp \
            $$PWD/seasidesimplecontactmodel.cpp \
            $$PWD/seasideconstituentmodel.cpp \
@@ -53,6 +56,9 @@ HEADERS += $$PWD/seasideperson.h \
            $$PWD/seasidefilteredmodel.h \
            $$PWD/seasidedisplaylabelgroupmodel.h \
            $$PWD/seasidestringlistcompressor.h \
+           $$PWD/seasidecharacterfolding.h \
+           $$PWD/seasidesearchprewarmer.h \
+           $$PWD/seasidesubstringsearch.h \
            $$PWD/seasidevcardmodel.h \
            $$PWD/seasidesimplecontactmodel.h \
            $$PWD/seasideconstituentmodel.h \
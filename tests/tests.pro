@@ -3,11 +3,13 @@ include(testdir.pri)
 TEMPLATE = subdirs
 SUBDIRS = \
           tst_synchronizelists \
+          tst_seasidecontactidlist \
           tst_seasideimport \
           tst_resolve \
           tst_seasideperson \
           tst_seasidefilteredmodel \
-          tst_seasidestringlistcompressor
+          tst_seasidestringlistcompressor \
+          tst_seasidesubstringsearch
 
 OTHER_FILES += $$PWD/tests.xml.in $$PWD/run_test.sh
 
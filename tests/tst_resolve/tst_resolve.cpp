@@ -32,6 +32,7 @@
 #include <QObject>
 #include <QtTest>
 #include <QtDebug>
+#include <QtConcurrentRun>
 
 #include <QContact>
 #include <QContactEmailAddress>
@@ -67,6 +68,9 @@ private slots:
     void resolveByEmailNotFound();
     void resolveByAccount();
     void resolveByAccountNotFound();
+    void resolveBatch();
+    void resolveFromSnapshot();
+    void demoteCompleteContacts();
 
     void resolveDuringContactLink();
 };
@@ -84,6 +88,23 @@ struct TestResolveListener : public SeasideCache::ResolveListener {
     SeasideCache::CacheItem *m_item;
 };
 
+typedef QPair<QString, QString> StringPair;
+
+struct TestBatchResolveListener : public SeasideCache::ResolveListener {
+    TestBatchResolveListener()
+        : m_batches(0)
+        { }
+
+    virtual void addressResolved(const QString &first, const QString &second, SeasideCache::CacheItem *item)
+        { m_addresses.append(qMakePair(first, second)); m_items.append(item); }
+    virtual void addressBatchResolved()
+        { ++m_batches; }
+
+    QList<StringPair> m_addresses;
+    QList<SeasideCache::CacheItem *> m_items;
+    int m_batches;
+};
+
 } // anonymous
 
 void tst_Resolve::initTestCase()
@@ -316,6 +337,115 @@ void tst_Resolve::resolveByAccountNotFound()
     QCOMPARE(item, (SeasideCache::CacheItem *)0);
 }
 
+void tst_Resolve::resolveBatch()
+{
+    TestBatchResolveListener listener;
+
+    QList<StringPair> addresses;
+    addresses << qMakePair(QString(), QString::fromLatin1("+358471112222"))
+              << qMakePair(QString::fromLatin1("daffy.d@example.com"), QString())
+              << qMakePair(QString(AccountPath), QString::fromLatin1("berta.b@geemail.com"))
+              << qMakePair(QString(), QString::fromLatin1("+358471112222"))
+              << qMakePair(QString::fromLatin1("nobody@example.com"), QString());
+    const QStringList names = QStringList() << "Carlo" << "Dafferd" << "Berta" << "Carlo" << QString();
+
+    const QList<SeasideCache::CacheItem *> items(SeasideCache::resolveAddresses(&listener, addresses, true));
+    QCOMPARE(items.count(), addresses.count());
+
+    // Each address not cached is reported once, however often it was requested
+    QSet<StringPair> unresolved;
+    for (int i = 0; i < items.count(); ++i) {
+        if (!items.at(i))
+            unresolved.insert(addresses.at(i));
+    }
+    QTRY_COMPARE(listener.m_addresses.count(), unresolved.count());
+    foreach (const StringPair &address, listener.m_addresses) {
+        QVERIFY(unresolved.remove(address));
+    }
+
+    // The addresses fit in a single fetch
+    QVERIFY(listener.m_batches <= 1);
+
+    for (int i = 0; i < addresses.count(); ++i) {
+        SeasideCache::CacheItem *item = items.at(i);
+        if (!item)
+            item = listener.m_items.at(listener.m_addresses.indexOf(addresses.at(i)));
+
+        if (names.at(i).isEmpty()) {
+            QCOMPARE(item, (SeasideCache::CacheItem *)0);
+        } else {
+            QVERIFY(item != 0);
+            QCOMPARE(item->contact.detail<QContactName>().firstName(), names.at(i));
+        }
+    }
+}
+
+void tst_Resolve::resolveFromSnapshot()
+{
+    SeasideCache::CacheItem *item;
+    TestResolveListener listener;
+    QString address("daffyd@example.com");
+
+    item = SeasideCache::resolveEmailAddress(&listener, address, false);
+    if (!item) {
+        QTRY_VERIFY(listener.m_resolved);
+        item = listener.m_item;
+    }
+    QVERIFY(item != 0);
+
+    // The resolved address becomes visible to other threads once the snapshot is published
+    const quint32 iid = item->iid;
+    QTRY_COMPARE(QtConcurrent::run([address]() {
+        return SeasideCache::addressSnapshot()->contactByEmailAddress(address).iid;
+    }).result(), iid);
+
+    const SeasideCache::AddressSnapshot::Contact contact(QtConcurrent::run([]() {
+        return SeasideCache::addressSnapshot()->contactByPhoneNumber(QString::fromLatin1("+358470009955"));
+    }).result());
+    QCOMPARE(contact.iid, iid);
+    QCOMPARE(contact.displayLabel, item->displayLabel);
+    QVERIFY(SeasideCache::addressSnapshot()->epoch() > 0);
+}
+
+void tst_Resolve::demoteCompleteContacts()
+{
+    SeasideCache::CacheItem *item;
+    TestResolveListener listener;
+
+    item = SeasideCache::resolvePhoneNumber(&listener, QString::fromLatin1("+358477758885"), true);
+    if (!item) {
+        QTRY_VERIFY(listener.m_resolved);
+        item = listener.m_item;
+    }
+    QVERIFY(item != 0);
+    QTRY_COMPARE(item->contactState, SeasideCache::ContactComplete);
+
+    const int demoted = SeasideCache::cacheStatistics().value(QStringLiteral("demotedContactCount")).toInt();
+
+    // Complete contacts in excess of the budget are demoted when the cache is idle
+    const qint64 budget = SeasideCache::completeContactBudget();
+    SeasideCache::setCompleteContactBudget(0);
+    QTRY_COMPARE(item->contactState, SeasideCache::ContactPartial);
+    QVERIFY(SeasideCache::cacheStatistics().value(QStringLiteral("demotedContactCount")).toInt() > demoted);
+
+    // The details needed for display are retained
+    QCOMPARE(item->contact.detail<QContactName>().firstName(), QString::fromLatin1("Ernest"));
+
+    // Addresses are retained, so the demoted contact still resolves
+    QCOMPARE(item->contact.details<QContactPhoneNumber>().count(), 1);
+    QCOMPARE(SeasideCache::itemByPhoneNumber(QString::fromLatin1("+358477758885")), item);
+    const quint32 iid = item->iid;
+    QTRY_COMPARE(QtConcurrent::run([]() {
+        return SeasideCache::addressSnapshot()->contactByPhoneNumber(QString::fromLatin1("+358477758885")).iid;
+    }).result(), iid);
+
+    SeasideCache::setCompleteContactBudget(budget);
+    SeasideCache::ensureCompletion(item);
+    QTRY_COMPARE(item->contactState, SeasideCache::ContactComplete);
+    QCOMPARE(item->contact.details<QContactPhoneNumber>().count(), 1);
+    QCOMPARE(SeasideCache::itemByPhoneNumber(QString::fromLatin1("+358477758885")), item);
+}
+
 struct ItemWatcher : public SeasideCache::ItemData {
     QList<int> m_constituents;
     bool m_aggregationComplete;
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2013 - 2020 Jolla Ltd.
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+#include <QObject>
+#include <QtTest>
+
+#include "seasidecontactidlist.h"
+
+class tst_SeasideContactIdList : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void append();
+    void insert();
+    void remove();
+    void duplicates();
+    void randomOperations();
+    void listView();
+
+private:
+    void verify(const SeasideContactIdList &list, const QList<quint32> &reference);
+};
+
+void tst_SeasideContactIdList::verify(const SeasideContactIdList &list, const QList<quint32> &reference)
+{
+    QCOMPARE(list.count(), reference.count());
+    QCOMPARE(list.toList(), reference);
+
+    for (int i = 0; i < reference.count(); ++i) {
+        QCOMPARE(list.at(i), reference.at(i));
+        QCOMPARE(list.indexOf(reference.at(i)), reference.indexOf(reference.at(i)));
+    }
+}
+
+void tst_SeasideContactIdList::append()
+{
+    SeasideContactIdList list;
+    QList<quint32> reference;
+    QVERIFY(list.isEmpty());
+    QCOMPARE(list.indexOf(1), -1);
+
+    for (quint32 i = 1; i <= 5 * SeasideContactIdList::ChunkSize + 3; ++i) {
+        list.append(i);
+        reference.append(i);
+    }
+    verify(list, reference);
+    QVERIFY(list.contains(1));
+    QVERIFY(!list.contains(0));
+
+    const SeasideContactIdList copy(reference);
+    verify(copy, reference);
+
+    list.clear();
+    QVERIFY(list.isEmpty());
+    QCOMPARE(list.indexOf(1), -1);
+}
+
+void tst_SeasideContactIdList::insert()
+{
+    SeasideContactIdList list;
+    QList<quint32> reference;
+
+    // Repeated insertion at the same position forces chunks to be split
+    for (quint32 i = 1; i <= 3 * SeasideContactIdList::ChunkSize; ++i) {
+        list.insert(0, i);
+        reference.insert(0, i);
+    }
+    verify(list, reference);
+
+    for (quint32 i = 0; i < 2 * SeasideContactIdList::ChunkSize; ++i) {
+        const int index = list.count() / 2;
+        list.insert(index, 10000 + i);
+        reference.insert(index, 10000 + i);
+    }
+    verify(list, reference);
+
+    list.insert(list.count(), 20000);
+    reference.append(20000);
+    verify(list, reference);
+}
+
+void tst_SeasideContactIdList::remove()
+{
+    SeasideContactIdList list;
+    QList<quint32> reference;
+
+    for (quint32 i = 1; i <= 4 * SeasideContactIdList::ChunkSize; ++i) {
+        list.append(i);
+        reference.append(i);
+    }
+
+    // Remove a range spanning several chunks
+    list.remove(10, 2 * SeasideContactIdList::ChunkSize);
+    reference.erase(reference.begin() + 10, reference.begin() + 10 + 2 * SeasideContactIdList::ChunkSize);
+    verify(list, reference);
+    QCOMPARE(list.indexOf(11), -1);
+
+    list.removeAt(0);
+    reference.removeAt(0);
+    list.removeAt(list.count() - 1);
+    reference.removeLast();
+    verify(list, reference);
+
+    list.remove(0, list.count());
+    QVERIFY(list.isEmpty());
+    QVERIFY(!list.contains(reference.first()));
+
+    list.append(1);
+    verify(list, QList<quint32>() << 1);
+}
+
+void tst_SeasideContactIdList::duplicates()
+{
+    // Ids may be duplicated transiently, while a list is synchronized
+    SeasideContactIdList list;
+    for (quint32 i = 0; i < 3 * SeasideContactIdList::ChunkSize; ++i)
+        list.append(i);
+
+    list.insert(SeasideContactIdList::ChunkSize * 2, 5);
+    QCOMPARE(list.indexOf(5), 5);
+
+    list.removeAt(5);
+    QCOMPARE(list.indexOf(5), SeasideContactIdList::ChunkSize * 2 - 1);
+
+    list.removeAt(SeasideContactIdList::ChunkSize * 2 - 1);
+    QCOMPARE(list.indexOf(5), -1);
+    QVERIFY(!list.contains(5));
+}
+
+void tst_SeasideContactIdList::randomOperations()
+{
+    SeasideContactIdList list;
+    QList<quint32> reference;
+
+    qsrand(1);
+    for (int i = 0; i < 20000; ++i) {
+        const int operation = qrand() % 4;
+        if (operation < 2 || reference.isEmpty()) {
+            const int index = qrand() % (reference.count() + 1);
+            const quint32 iid = qrand() % 2000;
+            list.insert(index, iid);
+            reference.insert(index, iid);
+        } else if (operation == 2) {
+            const int index = qrand() % reference.count();
+            const int count = qMin(reference.count() - index, 1 + qrand() % 300);
+            list.remove(index, count);
+            reference.erase(reference.begin() + index, reference.begin() + index + count);
+        } else {
+            const int index = qrand() % reference.count();
+            QCOMPARE(list.at(index), reference.at(index));
+            QCOMPARE(list.indexOf(reference.at(index)), reference.indexOf(reference.at(index)));
+        }
+        QCOMPARE(list.count(), reference.count());
+    }
+
+    verify(list, reference);
+}
+
+void tst_SeasideContactIdList::listView()
+{
+    SeasideContactIdList list;
+    QList<quint32> reference;
+    for (quint32 iid = 1; iid <= 1000; ++iid) {
+        list.append(iid);
+        reference.append(iid);
+    }
+
+    // The view is maintained once it has been requested
+    const QList<quint32> *view = list.listView();
+    QCOMPARE(*view, reference);
+
+    list.insert(500, 2000);
+    reference.insert(500, 2000);
+    list.remove(10, 300);
+    reference.erase(reference.begin() + 10, reference.begin() + 310);
+    list.append(3000);
+    reference.append(3000);
+    QCOMPARE(list.listView(), view);
+    QCOMPARE(*view, reference);
+
+    list = QList<quint32>() << 4 << 5 << 6;
+    QCOMPARE(*view, QList<quint32>() << 4 << 5 << 6);
+
+    list.clear();
+    QVERIFY(view->isEmpty());
+}
+
+#include "tst_seasidecontactidlist.moc"
+QTEST_APPLESS_MAIN(tst_SeasideContactIdList)
@@ -0,0 +1,4 @@
+include(../common.pri)
+TARGET = tst_seasidecontactidlist
+
+SOURCES += tst_seasidecontactidlist.cpp
@@ -36,6 +36,7 @@
 #include <QContactName>
 #include <QContactAvatar>
 #include <QContactEmailAddress>
+#include <QContactFavorite>
 #include <QContactPhoneNumber>
 
 #include <QtDebug>
@@ -132,6 +133,7 @@ quint32 SeasideCache::internalId(const QContactId &id)
 }
 
 SeasideCache::SeasideCache()
+    : m_displayOff(false)
 {
     instancePtr = this;
     for (int i = 0; i < FilterTypesCount; ++i) {
@@ -169,6 +171,12 @@ void SeasideCache::reset()
             contact.saveDetail(&avatar);
         }
 
+        if (contactsData[i].isFavorite) {
+            QContactFavorite favorite;
+            favorite.setFavorite(true);
+            contact.saveDetail(&favorite);
+        }
+
         QContactStatusFlags statusFlags;
 
         if (contactsData[i].email) {
@@ -408,6 +416,11 @@ void SeasideCache::fetchMergeCandidates(const QContact &contact)
 }
 
 const QList<quint32> *SeasideCache::contacts(FilterType filterType)
+{
+    return instancePtr->m_contacts[filterType].listView();
+}
+
+const SeasideContactIdList *SeasideCache::contactIdList(FilterType filterType)
 {
     return &instancePtr->m_contacts[filterType];
 }
@@ -417,6 +430,26 @@ bool SeasideCache::isPopulated(FilterType filterType)
     return instancePtr->m_populated[filterType];
 }
 
+bool SeasideCache::isDisplayOff()
+{
+    return instancePtr->m_displayOff;
+}
+
+void SeasideCache::setDisplayOff(bool off)
+{
+    if (m_displayOff != off) {
+        m_displayOff = off;
+        emit displayStateChanged();
+    }
+}
+
+QVariantMap SeasideCache::cacheStatistics()
+{
+    QVariantMap statistics;
+    statistics.insert(QStringLiteral("contactCount"), instancePtr->m_cache.count());
+    return statistics;
+}
+
 QString SeasideCache::getPrimaryName(const QContact &)
 {
     return QString();
@@ -531,8 +564,7 @@ void SeasideCache::remove(FilterType filterType, int index, int count)
     if (m_models[filterType])
         m_models[filterType]->sourceAboutToRemoveItems(index, index + count - 1);
 
-    QList<quint32>::iterator it = m_contacts[filterType].begin() + index;
-    m_contacts[filterType].erase(it, it + count);
+    m_contacts[filterType].remove(index, count);
 
     if (m_models[filterType]) {
         m_models[filterType]->sourceItemsRemoved();
@@ -540,6 +572,17 @@ void SeasideCache::remove(FilterType filterType, int index, int count)
     }
 }
 
+void SeasideCache::reorder(FilterType filterType, const QList<quint32> &ids)
+{
+    if (m_models[filterType])
+        m_models[filterType]->sourceAboutToChangeLayout();
+
+    m_contacts[filterType] = ids;
+
+    if (m_models[filterType])
+        m_models[filterType]->sourceLayoutChanged();
+}
+
 int SeasideCache::importContacts(const QString &)
 {
     return 0;
@@ -12,6 +12,9 @@
 #include <QContactName>
 
 #include <QAbstractListModel>
+#include <QVariantMap>
+
+#include <seasidecontactidlist.h>
 
 // Provide enough of SeasideCache's interface to support SeasideFilteredModel
 
@@ -42,6 +45,17 @@ public:
                           | FetchOrganization)
     };
 
+    enum ItemDataChange {
+        NameDataChanged = (1 << 0),
+        AvatarDataChanged = (1 << 1),
+        PresenceDataChanged = (1 << 2),
+        FavoriteDataChanged = (1 << 3),
+        AddressDataChanged = (1 << 4),
+        OrganizationDataChanged = (1 << 5),
+        NoteDataChanged = (1 << 6),
+        AllDataChanged = 0xffffffff
+    };
+
     enum DisplayLabelOrder {
         FirstNameFirst = 0,
         LastNameFirst
@@ -68,6 +82,8 @@ public:
 
         virtual void constituentsFetched(const QList<int> &ids) = 0;
         virtual void mergeCandidatesFetched(const QList<int> &ids) = 0;
+
+        virtual bool isActive() const { return true; }
     };
 
     struct CacheItem;
@@ -78,6 +94,8 @@ public:
         virtual void itemUpdated(CacheItem *) {};
         virtual void itemAboutToBeRemoved(CacheItem *) {};
 
+        virtual bool isActive() const { return true; }
+
         ItemListener *next;
     };
 
@@ -118,9 +136,15 @@ public:
         virtual void sourceItemsInserted(int begin, int end) = 0;
 
         virtual void sourceDataChanged(int begin, int end) = 0;
+        // The changes are a combination of ItemDataChange values
+        virtual void sourceDataChanged(int begin, int end, quint32 changes) { Q_UNUSED(changes) sourceDataChanged(begin, end); }
 
         virtual void sourceItemsChanged() = 0;
 
+        // The source list has been reordered in place
+        virtual void sourceAboutToChangeLayout() { emit layoutAboutToBeChanged(); }
+        virtual void sourceLayoutChanged() { emit layoutChanged(); }
+
         virtual void makePopulated() = 0;
         virtual void updateDisplayLabelOrder() = 0;
         virtual void updateSortProperty() = 0;
@@ -208,7 +232,10 @@ public:
     static void fetchMergeCandidates(const QContact &contact);
 
     static const QList<quint32> *contacts(FilterType filterType);
+    static const SeasideContactIdList *contactIdList(FilterType filterType);
     static bool isPopulated(FilterType filterType);
+    static QVariantMap cacheStatistics();
+    static bool isDisplayOff();
 
     static QString getPrimaryName(const QContact &contact);
     static QString getSecondaryName(const QContact &contact);
@@ -232,19 +259,22 @@ public:
     void populate(FilterType filterType);
     void insert(FilterType filterType, int index, const QList<quint32> &ids);
     void remove(FilterType filterType, int index, int count);
+    void reorder(FilterType filterType, const QList<quint32> &ids);
 
     static int importContacts(const QString &path);
     static QString exportContacts();
 
     void setFirstName(FilterType filterType, int index, const QString &name);
+    void setDisplayOff(bool off);
 
     void reset();
 
     static QList<quint32> getContactsForFilterType(FilterType filterType);
 
-    QList<quint32> m_contacts[FilterTypesCount];
+    SeasideContactIdList m_contacts[FilterTypesCount];
     ListModel *m_models[FilterTypesCount];
     bool m_populated[FilterTypesCount];
+    bool m_displayOff;
 
     QList<CacheItem> m_cache;
     QHash<quint32, int> m_cacheIndices;
@@ -253,6 +283,9 @@ public:
     static QStringList allContactDisplayLabelGroups;
 
     quint32 idAt(int index) const;
+
+signals:
+    void displayStateChanged();
 };
 
 
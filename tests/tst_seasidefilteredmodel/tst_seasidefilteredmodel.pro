@@ -1,5 +1,7 @@
 include(../common.pri)
 
+QT += concurrent
+
 PKGCONFIG += mlocale$${QT_MAJOR_VERSION}
 
 CONFIG += c++11
@@ -9,11 +11,16 @@ HEADERS += \
         seasidefilteredmodel.h \
         $$SRCDIR/seasidefilteredmodel.h \
         $$SRCDIR/seasideaddressbook.h \
-        $$SRCDIR/seasideperson.h
+        $$SRCDIR/seasideperson.h \
+        $$SRCDIR/seasidecharacterfolding.h \
+        $$SRCDIR/seasidesearchprewarmer.h \
+        $$SRCDIR/seasidesubstringsearch.h
 
 SOURCES += \
         seasidecache.cpp \
         tst_seasidefilteredmodel.cpp \
         $$SRCDIR/seasidefilteredmodel.cpp \
         $$SRCDIR/seasideaddressbook.cpp \
-        $$SRCDIR/seasideperson.cpp
+        $$SRCDIR/seasideperson.cpp \
+        $$SRCDIR/seasidesearchprewarmer.cpp \
+        $$SRCDIR/seasidesubstringsearch.cpp
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020 Open Mobile Platform LLC.
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * "Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Nemo Mobile nor the names of its contributors
+ *     may be used to endorse or promote products derived from this
+ *     software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+ */
+
+
+
+#include <QObject>
+#include <QtTest>
+
+#include <algorithm>
+
+#include "seasidesubstringsearch.h"
+
+class tst_SeasideSubstringSearch : public QObject
+{
+    Q_OBJECT
+public:
+    tst_SeasideSubstringSearch() {}
+
+private slots:
+    void commonPrefixLength();
+    void commonPrefixLength_data();
+    void compare();
+    void compare_data();
+    void randomized();
+    void benchmark();
+    void benchmark_data();
+
+private:
+    static QStringList searchKeys(int count);
+};
+
+void tst_SeasideSubstringSearch::commonPrefixLength_data()
+{
+    QTest::addColumn<QString>("lhs");
+    QTest::addColumn<QString>("rhs");
+    QTest::addColumn<int>("expected");
+
+    QTest::newRow("empty") << QString() << QString() << 0;
+    QTest::newRow("first differs") << QStringLiteral("abc") << QStringLiteral("xbc") << 0;
+    QTest::newRow("equal") << QStringLiteral("abc") << QStringLiteral("abc") << 3;
+    QTest::newRow("last of block differs") << QStringLiteral("abcdefgh") << QStringLiteral("abcdefgx") << 7;
+    QTest::newRow("first after block differs") << QStringLiteral("abcdefghi") << QStringLiteral("abcdefghx") << 8;
+    QTest::newRow("equal blocks") << QStringLiteral("abcdefghijklmnop") << QStringLiteral("abcdefghijklmnop") << 16;
+    QTest::newRow("phone number") << QStringLiteral("+358401234567") << QStringLiteral("+358401234467") << 10;
+    QTest::newRow("email") << QStringLiteral("firstname.lastname@example.com") << QStringLiteral("firstname.lastname@example.org") << 27;
+    QTest::newRow("non-latin") << QString::fromUtf8("иванов") << QString::fromUtf8("иванча") << 4;
+}
+
+void tst_SeasideSubstringSearch::commonPrefixLength()
+{
+    QFETCH(QString, lhs);
+    QFETCH(QString, rhs);
+    QFETCH(int, expected);
+
+    const int length = qMin(lhs.size(), rhs.size());
+    QCOMPARE(SeasideSubstringSearch::commonPrefixLength(lhs.constData(), rhs.constData(), length), expected);
+    QCOMPARE(SeasideSubstringSearch::commonPrefixLengthScalar(lhs.constData(), rhs.constData(), length), expected);
+}
+
+void tst_SeasideSubstringSearch::compare_data()
+{
+    QTest::addColumn<QString>("lhs");
+    QTest::addColumn<QString>("rhs");
+    QTest::addColumn<int>("expected");
+
+    QTest::newRow("empty") << QString() << QString() << 0;
+    QTest::newRow("empty first") << QString() << QStringLiteral("a") << -1;
+    QTest::newRow("prefix") << QStringLiteral("abc") << QStringLiteral("abcd") << -1;
+    QTest::newRow("extension") << QStringLiteral("abcdefghij") << QStringLiteral("abcdefghi") << 1;
+    QTest::newRow("equal") << QStringLiteral("abcdefghij") << QStringLiteral("abcdefghij") << 0;
+    QTest::newRow("less within block") << QStringLiteral("abcaefgh") << QStringLiteral("abcdefgh") << -1;
+    QTest::newRow("greater after block") << QStringLiteral("abcdefghz") << QStringLiteral("abcdefghij") << 1;
+    QTest::newRow("high code units") << QString::fromUtf8("abé") << QStringLiteral("abz") << 1;
+}
+
+void tst_SeasideSubstringSearch::compare()
+{
+    QFETCH(QString, lhs);
+    QFETCH(QString, rhs);
+    QFETCH(int, expected);
+
+    const int result = SeasideSubstringSearch::compare(lhs.constData(), lhs.size(), rhs.constData(), rhs.size());
+    QCOMPARE(result < 0 ? -1 : (result > 0 ? 1 : 0), expected);
+}
+
+void tst_SeasideSubstringSearch::randomized()
+{
+    // A small alphabet produces long common prefixes
+    qsrand(1);
+    for (int i = 0; i < 20000; ++i) {
+        QString lhs, rhs;
+        for (int n = qrand() % 40; n > 0; --n)
+            lhs.append(QChar('a' + qrand() % 2));
+        for (int n = qrand() % 40; n > 0; --n)
+            rhs.append(QChar('a' + qrand() % 2));
+
+        const int length = qMin(lhs.size(), rhs.size());
+        QCOMPARE(SeasideSubstringSearch::commonPrefixLength(lhs.constData(), rhs.constData(), length),
+                 SeasideSubstringSearch::commonPrefixLengthScalar(lhs.constData(), rhs.constData(), length));
+
+        const int result = SeasideSubstringSearch::compare(lhs.constData(), lhs.size(), rhs.constData(), rhs.size());
+        const int expected = lhs.compare(rhs);
+        QCOMPARE(result < 0, expected < 0);
+        QCOMPARE(result == 0, expected == 0);
+    }
+}
+
+QStringList tst_SeasideSubstringSearch::searchKeys(int count)
+{
+    // Keys resembling the phone numbers and email addresses of an address book
+    qsrand(2);
+    QStringList keys;
+    for (int i = 0; i < count; ++i) {
+        keys.append(QStringLiteral("+35840%1").arg(qrand() % 10000000, 7, 10, QChar('0')));
+        keys.append(QStringLiteral("contact.%1@example%2.com").arg(qrand() % 100000).arg(i % 10));
+    }
+    return keys;
+}
+
+void tst_SeasideSubstringSearch::benchmark_data()
+{
+    QTest::addColumn<bool>("vectorized");
+
+    QTest::newRow("scalar") << false;
+    QTest::newRow("vectorized") << true;
+}
+
+void tst_SeasideSubstringSearch::benchmark()
+{
+    QFETCH(bool, vectorized);
+
+    if (vectorized && !SeasideSubstringSearch::isVectorized())
+        QSKIP("No vector implementation for this architecture");
+
+    // Sort every suffix of the keys, as the search index does when contacts are indexed
+    const QStringList keys(searchKeys(2000));
+    QVector<QPair<const QString *, int> > suffixes;
+    for (const QString &key : keys) {
+        for (int offset = 0; offset < key.size(); ++offset)
+            suffixes.append(qMakePair(&key, offset));
+    }
+
+    const auto lessThan = [vectorized](const QPair<const QString *, int> &lhs, const QPair<const QString *, int> &rhs) {
+        const QChar *l = lhs.first->constData() + lhs.second;
+        const QChar *r = rhs.first->constData() + rhs.second;
+        const int lhsLength = lhs.first->size() - lhs.second;
+        const int rhsLength = rhs.first->size() - rhs.second;
+        if (vectorized)
+            return SeasideSubstringSearch::compare(l, lhsLength, r, rhsLength) < 0;
+
+        const int length = qMin(lhsLength, rhsLength);
+        const int common = SeasideSubstringSearch::commonPrefixLengthScalar(l, r, length);
+        return common < length ? l[common] < r[common] : lhsLength < rhsLength;
+    };
+
+    QVector<QPair<const QString *, int> > sorted;
+    QBENCHMARK {
+        sorted = suffixes;
+        std::sort(sorted.begin(), sorted.end(), lessThan);
+    }
+    QVERIFY(std::is_sorted(sorted.cbegin(), sorted.cend(), lessThan));
+}
+
+#include "tst_seasidesubstringsearch.moc"
+QTEST_APPLESS_MAIN(tst_SeasideSubstringSearch)
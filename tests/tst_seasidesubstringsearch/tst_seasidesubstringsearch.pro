@@ -0,0 +1,8 @@
+include(../common.pri)
+
+HEADERS += \
+        $$SRCDIR/seasidesubstringsearch.h
+
+SOURCES += \
+        $$SRCDIR/seasidesubstringsearch.cpp \
+        tst_seasidesubstringsearch.cpp